@@ -1,5 +1,6 @@
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/Binder.h"
+#include "CodeAnalysis/Value.h"
 #include <string>
 
 // enum class SyntaxKind
@@ -228,7 +229,7 @@ void PrintDiagnostic(Diagnostic diagnostic, SourceText Text)
     const std::string BLUE = "\033[34m";
 
     int lineIndex = Text.GetLineIndex(diagnostic.Location.Span.Start);
-    TextLine line = Text._lines[lineIndex];
+    TextLine line = Text.GetLine(lineIndex);
     int lineNumber = lineIndex + 1;
     int character = diagnostic.Location.Span.Start - line.Start + 1;
 
@@ -248,26 +249,14 @@ void PrintDiagnostic(Diagnostic diagnostic, SourceText Text)
               << suffix << std::endl;
 }
 
-void PrintVariables(const std::unordered_map<VariableSymbol, std::any> &variables)
+void PrintVariables(const std::unordered_map<VariableSymbol, Value> &variables)
 {
     for (const auto &[key, value] : variables)
     {
         std::cout << key << ": ";
-        if (value.type() == typeid(long long))
+        if (value.IsInteger() || value.IsFloat() || value.IsString())
         {
-            std::cout << std::any_cast<long long>(value);
-        }
-        else if (value.type() == typeid(int))
-        {
-            std::cout << std::any_cast<long long>(value);
-        }
-        else if (value.type() == typeid(double))
-        {
-            std::cout << std::any_cast<double>(value);
-        }
-        else if (value.type() == typeid(std::string))
-        {
-            std::cout << std::any_cast<std::string>(value);
+            std::cout << value;
         }
         else
         {
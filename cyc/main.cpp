@@ -120,20 +120,20 @@ int main(int argc, char *argv[])
             hasErrors = true;
             continue;
         }
-        SyntaxTree *syntaxTree = new SyntaxTree(SyntaxTree::Load(path));
+        SyntaxTree *syntaxTree = SyntaxTree::Load(path);
         syntaxTrees.push_back(syntaxTree);
     }
 
     if (hasErrors)
         return 1;
     Compilation compilation(syntaxTrees);
-    std::unordered_map<VariableSymbol, std::any> variables;
+    std::unordered_map<VariableSymbol, Value> variables;
     auto result = compilation.Compile(variables, outputFileName);
     if (result.Diagnostics.empty())
     {
-        if (result.Value.has_value())
+        if (result.Value.HasValue())
         {
-            // std::cout << std::any_cast<std::string>(result.Value) << std::endl;
+            // std::cout << result.Value << std::endl;
         }
     }
     else
@@ -13,6 +13,7 @@
 #include <set>
 #include <unordered_map>
 #include <vector>
+#include <stdexcept>
 
 namespace fs = std::filesystem;
 std::vector<std::string> GetFilePaths(const std::vector<std::string> &paths)
@@ -40,18 +41,67 @@ std::vector<std::string> GetFilePaths(const std::vector<std::string> &paths)
     return result;
 }
 
-void Repl();
+void Repl(ExecutionEngine engine, size_t stackLimit, size_t memoCapacity);
 
 int main(int argc, char *argv[])
 {
-    if (argc < 2)
+    ExecutionEngine engine = ExecutionEngine::TreeWalker;
+    size_t stackLimit = Evaluator::DefaultStackLimit;
+    size_t memoCapacity = 0;
+    std::vector<std::string> args;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--engine=vm")
+        {
+            engine = ExecutionEngine::VirtualMachine;
+        }
+        else if (arg == "--engine=tree")
+        {
+            engine = ExecutionEngine::TreeWalker;
+        }
+        else if (arg.rfind("--engine=", 0) == 0)
+        {
+            std::cerr << "error: unknown engine '" << arg.substr(9) << "', expected 'tree' or 'vm'" << std::endl;
+            return 1;
+        }
+        else if (arg.rfind("--stack-limit=", 0) == 0)
+        {
+            std::string megabytes = arg.substr(14);
+            if (megabytes.empty() || megabytes.find_first_not_of("0123456789") != std::string::npos)
+            {
+                std::cerr << "error: invalid stack limit '" << megabytes << "', expected a size in megabytes" << std::endl;
+                return 1;
+            }
+            stackLimit = std::stoull(megabytes) * 1024 * 1024;
+        }
+        else if (arg == "--memoize")
+        {
+            memoCapacity = Evaluator::DefaultMemoCapacity;
+        }
+        else if (arg.rfind("--memoize=", 0) == 0)
+        {
+            std::string entries = arg.substr(10);
+            if (entries.empty() || entries.find_first_not_of("0123456789") != std::string::npos)
+            {
+                std::cerr << "error: invalid memoize capacity '" << entries << "', expected a number of entries" << std::endl;
+                return 1;
+            }
+            memoCapacity = std::stoull(entries);
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.empty())
     {
-        Repl();
+        Repl(engine, stackLimit, memoCapacity);
     }
     else
     {
-        std::vector<std::string> args(argv + 1, argv + argc);
-
         auto paths = GetFilePaths(args);
         std::vector<SyntaxTree *> syntaxTrees;
         bool hasErrors = false;
@@ -65,20 +115,29 @@ int main(int argc, char *argv[])
                 hasErrors = true;
                 continue;
             }
-            SyntaxTree *syntaxTree = new SyntaxTree(SyntaxTree::Load(path));
+            SyntaxTree *syntaxTree = SyntaxTree::Load(path);
             syntaxTrees.push_back(syntaxTree);
         }
 
         if (hasErrors)
             return 1;
         Compilation compilation(syntaxTrees);
-        std::unordered_map<VariableSymbol, std::any> variables;
-        auto result = compilation.Evaluate(variables);
+        std::unordered_map<VariableSymbol, Value> variables;
+        EvaluationResult result({}, Value());
+        try
+        {
+            result = compilation.Evaluate(variables, engine, stackLimit, memoCapacity);
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << "error: " << error.what() << std::endl;
+            return 1;
+        }
         if (result.Diagnostics.empty())
         {
-            if (result.Value.has_value())
+            if (result.Value.HasValue())
             {
-                // std::cout << std::any_cast<std::string>(result.Value) << std::endl;
+                // std::cout << result.Value << std::endl;
             }
         }
         else
@@ -94,12 +153,12 @@ int main(int argc, char *argv[])
 const std::string BLUE = "\033[34m";
 const std::string RESET_COLOR = "\033[0m";
 const std::string GREEN = "\033[32m";
-void Repl()
+void Repl(ExecutionEngine engine, size_t stackLimit, size_t memoCapacity)
 {
 
     std::string textBuilder;
     bool showTree = false;
-    std::unordered_map<VariableSymbol, std::any> variables;
+    std::unordered_map<VariableSymbol, Value> variables;
     bool showProgram = false;
     bool showBoundTree = false;
     Compilation *previous = nullptr;
@@ -154,27 +213,33 @@ void Repl()
             }
             else if (input == "#reset")
             {
-                previous = nullptr;
+                while (previous != nullptr)
+                {
+                    Compilation *earlier = previous->Previous;
+                    delete previous;
+                    previous = earlier;
+                }
                 variables.clear();
                 continue;
             }
         }
 
         textBuilder += input + "\n";
-        SyntaxTree Root = SyntaxTree::Parse(textBuilder);
+        SyntaxTree *Root = SyntaxTree::Parse(textBuilder);
 
-        if (!isBlank && Root.Diagnostics.size() > 0)
+        if (!isBlank && Root->Diagnostics.size() > 0)
         {
+            delete Root;
             continue;
         }
 
-        Compilation *compilation = previous == nullptr ? new Compilation({&Root}) : previous->ContinueWith(&Root);
+        Compilation *compilation = previous == nullptr ? new Compilation({Root}) : previous->ContinueWith(Root);
 
         if (showTree)
         {
 
             std::cout << BLUE << "Abstract Syntax Tree" << std::endl;
-            Root.Root->WriteTo(std::cout);
+            Root->Root->WriteTo(std::cout);
         }
 
         if (showProgram)
@@ -188,7 +253,19 @@ void Repl()
             compilation->EmitBoundTree(std::cout);
         }
 
-        EvaluationResult result = compilation->Evaluate(variables);
+        EvaluationResult result({}, Value());
+        try
+        {
+            result = compilation->Evaluate(variables, engine, stackLimit, memoCapacity);
+        }
+        catch (const std::exception &error)
+        {
+            std::cout << "error: " << error.what() << std::endl;
+            std::cout << "Evaluation failed." << std::endl;
+            delete compilation;
+            textBuilder.clear();
+            continue;
+        }
 
         if (result.Diagnostics.size() > 0)
         {
@@ -203,77 +280,12 @@ void Repl()
             //     PrintDiagnostic(diagnostic, Root.Text);
             // }
             std::cout << "Evaluation failed." << std::endl;
+            delete compilation;
         }
         else
         {
             std::cout << std::endl;
-            if (result.Value.type() == typeid(long long))
-            {
-                std::cout << std::any_cast<long long>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(float))
-            {
-                std::cout << std::any_cast<double>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(double))
-            {
-                std::cout << std::any_cast<double>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(int))
-            {
-                std::cout << (long long)std::any_cast<int>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(bool))
-            {
-                std::cout << std::any_cast<bool>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(std::string))
-            {
-                std::cout << std::any_cast<std::string>(result.Value) << std::endl;
-            }
-            else if (result.Value.type() == typeid(std::vector<std::any>))
-            {
-                auto values = std::any_cast<std::vector<std::any>>(result.Value);
-                for (auto &value : values)
-                {
-                    if (value.type() == typeid(long long))
-                    {
-                        std::cout << std::any_cast<long long>(value) << " ";
-                    }
-                    if (value.type() == typeid(float))
-                    {
-                        std::cout << std::any_cast<double>(value) << " ";
-                    }
-                    else if (value.type() == typeid(double))
-                    {
-                        std::cout << std::any_cast<double>(value) << " ";
-                    }
-                    else if (value.type() == typeid(int))
-                    {
-                        std::cout << (long long)std::any_cast<int>(value) << " ";
-                    }
-                    else if (value.type() == typeid(bool))
-                    {
-                        std::cout << std::any_cast<bool>(value) << " ";
-                    }
-                    else if (value.type() == typeid(std::string))
-                    {
-                        std::cout << std::any_cast<std::string>(value) << " ";
-                    }
-                }
-                std::cout << std::endl;
-            }
-            else
-            {
-                try
-                {
-                    std::cout << std::any_cast<std::string>(result.Value) << std::endl;
-                }
-                catch (const std::bad_any_cast &e)
-                {
-                    std::cout << std::endl;
-                }
-            }
+            std::cout << result.Value << std::endl;
             previous = compilation;
         }
 
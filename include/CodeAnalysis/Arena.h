@@ -0,0 +1,71 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for tree nodes. Objects are carved out of large blocks and
+// are all destroyed, in reverse order, when the arena goes away. Blocks start
+// small and double in size, so arenas for tiny inputs stay cheap.
+class Arena
+{
+public:
+    Arena() {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    ~Arena()
+    {
+        for (auto it = _destructors.rbegin(); it != _destructors.rend(); ++it)
+            it->second(it->first);
+    }
+
+    template <typename T, typename... Args>
+    T *New(Args &&...args)
+    {
+        T *object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            _destructors.emplace_back(object, [](void *pointer)
+                                      { static_cast<T *>(pointer)->~T(); });
+        return object;
+    }
+
+private:
+    static constexpr size_t FirstBlockSize = 1024;
+    static constexpr size_t BlockSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char *_next = nullptr;
+    char *_end = nullptr;
+    size_t _blockSize = FirstBlockSize;
+    std::vector<std::pair<void *, void (*)(void *)>> _destructors;
+
+    static size_t Padding(const char *pointer, size_t alignment)
+    {
+        return (alignment - reinterpret_cast<uintptr_t>(pointer) % alignment) % alignment;
+    }
+
+    void *Allocate(size_t size, size_t alignment)
+    {
+        if (_next == nullptr || Padding(_next, alignment) + size > static_cast<size_t>(_end - _next))
+        {
+            size_t blockSize = std::max(_blockSize, size + alignment);
+            _blockSize = std::min(_blockSize * 2, BlockSize);
+            _blocks.emplace_back(new char[blockSize]);
+            _next = _blocks.back().get();
+            _end = _next + blockSize;
+        }
+
+        char *result = _next + Padding(_next, alignment);
+        _next = result + size;
+        return result;
+    }
+};
+
+#endif
@@ -4,7 +4,10 @@
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/Symbol.h"
 #include "CodeAnalysis/IndentedTextWriter.h"
+#include "CodeAnalysis/Value.h"
+#include "CodeAnalysis/Arena.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <any>
 #include <stack>
 enum class BoundNodeKind
@@ -33,6 +36,7 @@ enum class BoundNodeKind
     GotoStatement,
     LabelStatement,
     ConditionalGotoStatement,
+    CountedGotoStatement,
 };
 
 enum class BoundUnaryOperatorKind
@@ -155,6 +159,8 @@ class BoundBlockStatement : public BoundStatement
 public:
     BoundBlockStatement(std::vector<BoundStatement *> statements) : Statements(statements) {};
     std::vector<BoundStatement *> Statements;
+    int LocalCount = 0;
+    bool LabelsResolved = false;
     BoundNodeKind kind = BoundNodeKind::BlockStatement;
     BoundNodeKind GetKind() const override { return kind; }
 
@@ -178,10 +184,11 @@ class BoundLabel
 {
 public:
     std::string Name;
-    BoundLabel(std::string name) : Name(name) {}
+    int Id;
+    BoundLabel(std::string name) : Name(name), Id(NextId()) {}
     bool operator==(const BoundLabel &other) const
     {
-        return Name == other.Name;
+        return Id == other.Id;
     }
     std::string ToString() const
     {
@@ -193,6 +200,13 @@ public:
         os << "LabelSymbol(Name: " << label.Name << ")";
         return os;
     }
+
+private:
+    static int NextId()
+    {
+        static int nextId = 0;
+        return nextId++;
+    }
 };
 namespace std
 {
@@ -201,7 +215,7 @@ namespace std
     {
         std::size_t operator()(const BoundLabel &symbol) const
         {
-            return std::hash<std::string>()(symbol.Name);
+            return std::hash<int>()(symbol.Id);
         }
     };
 }
@@ -231,6 +245,7 @@ public:
     BoundGotoStatement(BoundLabel label) : Label(label) {};
     BoundNodeKind kind = BoundNodeKind::GotoStatement;
     BoundLabel Label;
+    int Target = -1;
     BoundNodeKind GetKind() const override { return kind; }
 
     std::vector<std::pair<std::string, std::string>> GetProperties() const override
@@ -251,6 +266,7 @@ public:
     BoundLabel Label;
     BoundExpression *Condition;
     bool JumpIfTrue;
+    int Target = -1;
     BoundNodeKind kind = BoundNodeKind::ConditionalGotoStatement;
     BoundNodeKind GetKind() const override { return kind; }
 
@@ -265,6 +281,30 @@ public:
     }
 };
 
+// Closes a lowered for loop: Variable = Variable + 1, then jumps to Label
+// while Variable <= UpperBound. UpperBound is evaluated before the loop.
+class BoundCountedGotoStatement : public BoundStatement
+{
+public:
+    BoundCountedGotoStatement(BoundLabel label, BoundExpression *variable, BoundExpression *upperBound) : Label(label), Variable(variable), UpperBound(upperBound) {};
+    BoundLabel Label;
+    BoundExpression *Variable;
+    BoundExpression *UpperBound;
+    int Target = -1;
+    BoundNodeKind kind = BoundNodeKind::CountedGotoStatement;
+    BoundNodeKind GetKind() const override { return kind; }
+
+    std::vector<std::pair<std::string, std::string>> GetProperties() const override
+    {
+        return {{"Label", Label.ToString()}, {"Variable", ""}, {"UpperBound", ""}};
+    }
+
+    std::vector<BoundNode *> GetChildren() const override
+    {
+        return {Variable, UpperBound};
+    }
+};
+
 class BoundIfStatement : public BoundStatement
 {
 public:
@@ -369,6 +409,11 @@ public:
         return {{"Expression", ""}};
     }
 };
+// Operators carry a handler specialized for their operand types, so
+// evaluating one is a single indirect call with no type checks.
+using UnaryOperatorHandler = Value (*)(const Value &operand);
+using BinaryOperatorHandler = Value (*)(const Value &left, const Value &right);
+
 class BoundUnaryOperator
 {
 public:
@@ -376,12 +421,13 @@ public:
     BoundUnaryOperatorKind Kind;
     TypeSymbol OperandType;
     TypeSymbol ResultType;
-    static BoundUnaryOperator *Bind(SyntaxKind syntaxKind, TypeSymbol operandType);
+    UnaryOperatorHandler Handler;
+    static const BoundUnaryOperator *Bind(SyntaxKind syntaxKind, TypeSymbol operandType);
     std::string ToString() const;
 
 private:
-    BoundUnaryOperator(SyntaxKind syntaxKind, BoundUnaryOperatorKind kind, TypeSymbol operandType, TypeSymbol resultType) : syntaxKind(syntaxKind), Kind(kind), OperandType(operandType), ResultType(resultType) {};
-    BoundUnaryOperator(SyntaxKind syntaxKind, BoundUnaryOperatorKind kind, TypeSymbol operandType) : BoundUnaryOperator(syntaxKind, kind, operandType, operandType) {};
+    BoundUnaryOperator(SyntaxKind syntaxKind, BoundUnaryOperatorKind kind, TypeSymbol operandType, TypeSymbol resultType, UnaryOperatorHandler handler) : syntaxKind(syntaxKind), Kind(kind), OperandType(operandType), ResultType(resultType), Handler(handler) {};
+    BoundUnaryOperator(SyntaxKind syntaxKind, BoundUnaryOperatorKind kind, TypeSymbol operandType, UnaryOperatorHandler handler) : BoundUnaryOperator(syntaxKind, kind, operandType, operandType, handler) {};
     static const std::vector<BoundUnaryOperator> operators;
 };
 
@@ -393,13 +439,14 @@ public:
     TypeSymbol LeftType;
     TypeSymbol RightType;
     TypeSymbol ResultType;
-    static BoundBinaryOperator *Bind(SyntaxKind syntaxKind, TypeSymbol leftType, TypeSymbol rightType);
+    BinaryOperatorHandler Handler;
+    static const BoundBinaryOperator *Bind(SyntaxKind syntaxKind, TypeSymbol leftType, TypeSymbol rightType);
     std::string ToString() const;
 
 private:
-    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol leftType, TypeSymbol rightTpye, TypeSymbol resultType) : syntaxKind(syntaxKind), Kind(kind), LeftType(leftType), RightType(rightTpye), ResultType(resultType) {};
-    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol operandType, TypeSymbol resultType) : BoundBinaryOperator(syntaxKind, kind, operandType, operandType, resultType) {};
-    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol type) : BoundBinaryOperator(syntaxKind, kind, type, type, type) {};
+    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol leftType, TypeSymbol rightTpye, TypeSymbol resultType, BinaryOperatorHandler handler) : syntaxKind(syntaxKind), Kind(kind), LeftType(leftType), RightType(rightTpye), ResultType(resultType), Handler(handler) {};
+    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol operandType, TypeSymbol resultType, BinaryOperatorHandler handler) : BoundBinaryOperator(syntaxKind, kind, operandType, operandType, resultType, handler) {};
+    BoundBinaryOperator(SyntaxKind syntaxKind, BoundBinaryOperatorKind kind, TypeSymbol type, BinaryOperatorHandler handler) : BoundBinaryOperator(syntaxKind, kind, type, type, type, handler) {};
     static const std::vector<BoundBinaryOperator> operators;
 };
 class BoundErrorExpression : public BoundExpression
@@ -466,9 +513,9 @@ public:
 class BoundUnaryExpression : public BoundExpression
 {
 public:
-    BoundUnaryExpression(BoundUnaryOperator *op, BoundExpression *operand) : BoundExpression(op->ResultType), Op(op), Operand(operand), type(op->ResultType) {};
+    BoundUnaryExpression(const BoundUnaryOperator *op, BoundExpression *operand) : BoundExpression(op->ResultType), Op(op), Operand(operand), type(op->ResultType) {};
     BoundNodeKind kind = BoundNodeKind::UnaryExpression;
-    BoundUnaryOperator *Op;
+    const BoundUnaryOperator *Op;
     BoundExpression *Operand;
     TypeSymbol type;
     BoundNodeKind GetKind() const override { return BoundNodeKind::UnaryExpression; }
@@ -491,6 +538,7 @@ public:
     BoundNodeKind kind = BoundNodeKind::LiteralExpression;
     std::string Value;
     TypeSymbol type;
+    int ConstantIndex = -1;
     BoundNodeKind GetKind() const override { return BoundNodeKind::LiteralExpression; }
 
     std::vector<std::pair<std::string, std::string>> GetProperties() const override
@@ -571,9 +619,9 @@ public:
 class BoundBinaryExpression : public BoundExpression
 {
 public:
-    BoundBinaryExpression(BoundExpression *left, BoundBinaryOperator *op, BoundExpression *right) : BoundExpression(op->ResultType), Left(left), Op(op), Right(right), type(op->ResultType) {};
+    BoundBinaryExpression(BoundExpression *left, const BoundBinaryOperator *op, BoundExpression *right) : BoundExpression(op->ResultType), Left(left), Op(op), Right(right), type(op->ResultType) {};
     BoundNodeKind kind = BoundNodeKind::BinaryExpression;
-    BoundBinaryOperator *Op;
+    const BoundBinaryOperator *Op;
     BoundExpression *Left;
     BoundExpression *Right;
     TypeSymbol type;
@@ -598,6 +646,7 @@ public:
     FunctionSymbol Function;
     std::vector<BoundExpression *> Arguments;
     TypeSymbol type;
+    BoundBlockStatement *Body = nullptr;
     BoundNodeKind GetKind() const override { return BoundNodeKind::CallExpression; }
 
     std::vector<BoundNode *> GetChildren() const override
@@ -649,30 +698,40 @@ private:
     std::unordered_map<std::string, FunctionSymbol> _functions;
 };
 
+// Owns the nodes bound for its statements; Previous is owned elsewhere.
 class BoundGlobalScope
 {
 public:
-    BoundGlobalScope(BoundGlobalScope *previous, std::vector<Diagnostic> diagnostics, std::vector<VariableSymbol> variables, std::vector<FunctionSymbol> functions, std::vector<BoundStatement *> statements) : Previous(previous), Diagnostics(diagnostics), Variables(variables), Functions(functions), Statements(statements) {}
+    BoundGlobalScope(BoundGlobalScope *previous) : Previous(previous) {}
     BoundGlobalScope *Previous;
     std::vector<Diagnostic> Diagnostics;
     std::vector<VariableSymbol> Variables;
     std::vector<FunctionSymbol> Functions;
     std::vector<BoundStatement *> Statements;
+    int GlobalCount = 0;
+    Arena Nodes;
 };
 
+// Owns every node created while binding and lowering it. Unchanged subtrees
+// of the global scope's statements are shared, so it must not outlive it.
 class BoundProgram
 {
 public:
     std::vector<Diagnostic> Diagnostics;
     std::unordered_map<FunctionSymbol, BoundBlockStatement *> Functions;
-    BoundBlockStatement *statement;
+    BoundBlockStatement *statement = nullptr;
+    std::vector<VariableSymbol> Globals;
+    int GlobalCount;
+    std::vector<Value> Constants;
+    std::unordered_set<FunctionSymbol> PureFunctions;
+    Arena Nodes;
 
-    BoundProgram(std::vector<Diagnostic> diagnostics, std::unordered_map<FunctionSymbol, BoundBlockStatement *> functions, BoundBlockStatement *statement) : Diagnostics(diagnostics), Functions(functions), statement(statement) {}
+    BoundProgram(std::vector<VariableSymbol> globals, int globalCount) : Globals(globals), GlobalCount(globalCount) {}
 };
 class Binder
 {
 public:
-    Binder(BoundScope *parent, FunctionSymbol *function) : _scope(new BoundScope(parent)), _function(function)
+    Binder(Arena *arena, BoundScope *parent, FunctionSymbol *function) : _arena(arena), _scope(_scopes.New<BoundScope>(parent)), _function(function)
     {
         if (_function != nullptr)
         {
@@ -680,6 +739,7 @@ public:
             {
                 _scope->TryDeclareVariable(param);
             }
+            _localCount = _function->Parameters.size();
         }
     };
 
@@ -693,18 +753,23 @@ public:
 
 private:
     DiagnosticBag _diagnostics;
+    Arena *_arena;
+    Arena _scopes;
     BoundScope *_scope;
     FunctionSymbol *_function;
     std::stack<std::pair<BoundLabel, BoundLabel>> _loopStack;
     int _labelCounter = 0;
+    int _localCount = 0;
+    int _globalCount = 0;
 
     TypeSymbol LookupType(std::string name);
     BoundExpression *BindExpression(SyntaxNode *node, bool canBeVoid = false);
     BoundExpression *BindExpression(SyntaxNode *node, TypeSymbol type);
     BoundExpression *BindExpressionInternal(SyntaxNode *node);
 
-    static BoundScope *CreateParentScope(BoundGlobalScope *previous);
-    static BoundScope *CreateRootScope();
+    static BoundScope *CreateParentScope(Arena *arena, BoundGlobalScope *previous);
+    static BoundScope *CreateRootScope(Arena *arena);
+    static std::vector<VariableSymbol> GetGlobals(BoundGlobalScope *globalScope);
     BoundExpression *GetDefaultValueExpression(TypeSymbol type, int arrSize = 0);
     BoundStatement *BindStatement(StatementSyntax *node);
     BoundStatement *BindBlockStatement(BlockStatementSyntax *node);
@@ -734,7 +799,7 @@ private:
     BoundExpression *BindAssignmentExpression(AssignmentExpressionNode *node);
     BoundExpression *BindCallExpression(CallExpressionNode *node);
     BoundExpression *BindConversion(SyntaxNode *node, TypeSymbol type, bool allowExplicit = false);
-    BoundExpression *BindConversion(TextLocation diagnosticLocation, BoundExpression *expression, TypeSymbol type, bool allowExplicit = false);
+    BoundExpression *BindConversion(const SyntaxNode *diagnosticNode, BoundExpression *expression, TypeSymbol type, bool allowExplicit = false);
     BoundExpression *BindArrayAccessExpression(ArrayAccessExpressionSyntax *node);
     BoundExpression *BindArrayAssignmentExpression(ArrayAssignmentExpressionSyntax *node);
 };
@@ -777,6 +842,7 @@ private:
     static void WriteLabelStatement(const BoundLabelStatement *node, IndentedTextWriter &writer);
     static void WriteGotoStatement(const BoundGotoStatement *node, IndentedTextWriter &writer);
     static void WriteConditionalGotoStatement(const BoundConditionalGotoStatement *node, IndentedTextWriter &writer);
+    static void WriteCountedGotoStatement(const BoundCountedGotoStatement *node, IndentedTextWriter &writer);
     static void WriteReturnStatement(const BoundReturnStatement *node, IndentedTextWriter &writer);
     static void WriteExpressionStatement(const BoundExpressionStatement *node, IndentedTextWriter &writer);
     static void WriteErrorExpression(const BoundErrorExpression *node, IndentedTextWriter &writer);
@@ -3,27 +3,40 @@
 #include "CodeAnalysis/Diagnostic.h"
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/Binder.h"
-#include <any>
+#include "CodeAnalysis/Evaluator.h"
+#include "CodeAnalysis/Value.h"
 #include <unordered_map>
 #include <atomic>
+enum class ExecutionEngine
+{
+    TreeWalker,
+    VirtualMachine,
+};
+
 class EvaluationResult
 {
 public:
-    EvaluationResult(std::vector<Diagnostic> diagnostics, std::any value) : Diagnostics(diagnostics), Value(value) {}
+    EvaluationResult(std::vector<Diagnostic> diagnostics, ::Value value) : Diagnostics(diagnostics), Value(value) {}
     std::vector<Diagnostic> Diagnostics;
-    std::any Value;
+    ::Value Value;
 };
 
+// A compilation owns the syntax trees it is given and deletes them with
+// itself, along with everything bound from them. It does not own Previous.
+// Programs are bound once and reused until the compilation is continued.
 class Compilation
 {
 public:
     Compilation(Compilation *previous, std::vector<SyntaxTree *> syntaxTrees) : Previous(previous), syntaxTrees(syntaxTrees) {}
     Compilation(std::vector<SyntaxTree *> syntaxTrees) : Compilation(nullptr, syntaxTrees) {}
+    Compilation(const Compilation &) = delete;
+    Compilation &operator=(const Compilation &) = delete;
+    ~Compilation();
     Compilation *Previous;
 
     BoundGlobalScope *GlobalScope();
-    EvaluationResult Evaluate(std::unordered_map<VariableSymbol, std::any> &variables);
-    EvaluationResult Compile(std::unordered_map<VariableSymbol, std::any> &variables, std::string outputFileName = "");
+    EvaluationResult Evaluate(std::unordered_map<VariableSymbol, Value> &variables, ExecutionEngine engine = ExecutionEngine::TreeWalker, size_t stackLimit = Evaluator::DefaultStackLimit, size_t memoCapacity = 0);
+    EvaluationResult Compile(std::unordered_map<VariableSymbol, Value> &variables, std::string outputFileName = "");
     Compilation *ContinueWith(SyntaxTree *syntaxTree);
 
     void EmitTree(std::ostream &os);
@@ -31,7 +44,13 @@ public:
 
 private:
     BoundGlobalScope *_globalScope = nullptr;
+    BoundProgram *_program = nullptr;
+    BoundProgram *_emitableProgram = nullptr;
     std::vector<SyntaxTree *> syntaxTrees;
+
+    BoundProgram *Program();
+    BoundProgram *EmitableProgram();
+    void ReleasePrograms();
 };
 
 #endif
\ No newline at end of file
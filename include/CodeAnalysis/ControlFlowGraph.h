@@ -19,15 +19,24 @@ public:
     std::vector<BasicBlock *> Blocks;
     std::vector<BasicBlockBranch *> Branches;
 
+    ControlFlowGraph(const ControlFlowGraph &) = delete;
+    ControlFlowGraph &operator=(const ControlFlowGraph &) = delete;
+    ~ControlFlowGraph();
+
     static ControlFlowGraph *Create(BoundBlockStatement *body);
     static bool AllPathsReturn(BoundBlockStatement *body);
     void WriteTo(std::ostream &writer) const;
 
 private:
+    // Branch conditions synthesized for the graph; the statements' own
+    // expressions belong to the bound tree.
+    std::vector<BoundExpression *> _conditions;
+
     ControlFlowGraph(BasicBlock *start, BasicBlock *end,
                      std::vector<BasicBlock *> blocks,
-                     std::vector<BasicBlockBranch *> branches)
-        : Start(start), End(end), Blocks(blocks), Branches(branches) {};
+                     std::vector<BasicBlockBranch *> branches,
+                     std::vector<BoundExpression *> conditions)
+        : Start(start), End(end), Blocks(blocks), Branches(branches), _conditions(conditions) {};
 
 public:
     class BasicBlock
@@ -128,6 +137,7 @@ public:
         std::unordered_map<BoundStatement *, BasicBlock *> _blockFromStatement;
         std::unordered_map<BoundLabel, BasicBlock *> _blockFromLabel;
         std::vector<BasicBlockBranch *> _branches;
+        std::vector<BoundExpression *> _conditions;
         BasicBlock *_start = new BasicBlock(true);
         BasicBlock *_end = new BasicBlock(false);
     };
@@ -2,46 +2,91 @@
 #define EVALUATOR_H
 
 #include "CodeAnalysis/Binder.h"
-#include <any>
+#include "CodeAnalysis/Value.h"
+#include <list>
 #include <unordered_map>
-#include <stack>
+#include <unordered_set>
+#include <vector>
 
 class Evaluator
 {
 public:
-    Evaluator(BoundProgram *program, std::unordered_map<VariableSymbol, std::any> &variables) : _program(program), _globals(variables)
+    static const size_t DefaultStackLimit = 256 * 1024 * 1024;
+    static const size_t DefaultMemoCapacity = 65536;
+
+    Evaluator(BoundProgram *program, std::unordered_map<VariableSymbol, Value> &variables, size_t stackLimit = DefaultStackLimit, size_t memoCapacity = 0) : _program(program), _variables(variables), _stackLimit(stackLimit), _memoCapacity(memoCapacity) {}
+    Value Evaluate();
+
+    Value EvaluateExpression(BoundExpression *node);
+
+    static Value ApplyConversion(const TypeSymbol &type, const Value &value);
+    static ValueKind GetElementKind(const TypeSymbol &arrayType);
+    static Value LoadElement(const Value &target, long long index);
+    static void StoreElement(Value &target, long long index, const Value &value);
+    static bool IsBuiltInFunction(const FunctionSymbol &function);
+    static Value CallBuiltInFunction(const FunctionSymbol &function, const Value *arguments);
+
+private:
+    struct Frame
     {
-        _locals.push(std::unordered_map<VariableSymbol, std::any>());
-    }
-    std::any Evaluate()
+        BoundBlockStatement *Body;
+        size_t Index;
+        size_t Base;
+        bool Memoized;
+    };
+
+    struct MemoKey
     {
-        return EvaluateStatement(_program->statement);
+        BoundBlockStatement *Body;
+        std::vector<Value> Arguments;
+        bool operator==(const MemoKey &other) const;
     };
 
-    std::any EvaluateExpression(BoundExpression *node);
+    struct MemoKeyHash
+    {
+        size_t operator()(const MemoKey &key) const;
+    };
 
-private:
     BoundProgram *_program;
-    std::unordered_map<VariableSymbol, std::any> &_globals;
-    std::stack<std::unordered_map<VariableSymbol, std::any>> _locals;
+    std::unordered_map<VariableSymbol, Value> &_variables;
+    std::vector<Value> _globals;
+    std::vector<Value> _locals;
+    std::vector<Value> _arguments;
+    std::vector<Frame> _frames;
+    size_t _frameBase = 0;
+    size_t _stackLimit;
+
+    // Results of pure functions, most recently used first, when --memoize
+    // is on. _memoKeys holds the key of every memoized frame on the stack.
+    size_t _memoCapacity;
+    std::unordered_set<BoundBlockStatement *> _memoBodies;
+    std::list<std::pair<MemoKey, Value>> _memoEntries;
+    std::unordered_map<MemoKey, std::list<std::pair<MemoKey, Value>>::iterator, MemoKeyHash> _memoIndex;
+    std::vector<MemoKey> _memoKeys;
+    Value _callResult;
 
     void EvaluateExpressionStatement(BoundExpressionStatement *node);
     void EvaluateVariableDeclaration(BoundVariableDeclaration *node);
-    void Assign(VariableSymbol variable, std::any value);
-    // void AssignArray(VariableSymbol variable, std::any value, int index);
-    std::any EvaluateStatement(BoundBlockStatement *node);
-
-    std::any EvaluateLiteralExpression(BoundLiteralExpression *node);
-    std::any EvaluateVariableExpression(BoundVariableExpression *node);
-    std::any EvaluateAssignmentExpression(BoundAssignmentExpression *node);
-    std::any EvaluateUnaryExpression(BoundUnaryExpression *node);
-    std::any EvaluateBinaryExpression(BoundBinaryExpression *node);
-    std::any EvaluateCallExpression(BoundCallExpression *node);
-    std::any EvaluateConversionExpression(BoundConversionExpression *node);
-    std::any EvaluateArrayInitializerExpression(BoundArrayInitializerExpression *node);
-    std::any EvaluateArrayAccessExpression(BoundArrayAccessExpression *node);
-    std::any EvaluateArrayAssignmentExpression(BoundArrayAssignmentExpression *node);
-    std::any _lastValue = "";
+    void Assign(const VariableSymbol &variable, Value value);
+    Value &Lookup(const VariableSymbol &variable);
+    // void AssignArray(VariableSymbol variable, Value value, int index);
+    Value Run(size_t depth);
+    bool PushFrame(BoundCallExpression *call);
+    void Remember(MemoKey key, const Value &value);
+    void ReplaceFrame(BoundCallExpression *call);
+    void CompleteCall(Value value);
+
+    Value EvaluateLiteralExpression(BoundLiteralExpression *node);
+    Value EvaluateVariableExpression(BoundVariableExpression *node);
+    Value EvaluateAssignmentExpression(BoundAssignmentExpression *node);
+    Value EvaluateUnaryExpression(BoundUnaryExpression *node);
+    Value EvaluateBinaryExpression(BoundBinaryExpression *node);
+    Value EvaluateCallExpression(BoundCallExpression *node);
+    Value EvaluateConversionExpression(BoundConversionExpression *node);
+    Value EvaluateArrayInitializerExpression(BoundArrayInitializerExpression *node);
+    Value EvaluateArrayAccessExpression(BoundArrayAccessExpression *node);
+    Value EvaluateArrayAssignmentExpression(BoundArrayAssignmentExpression *node);
+    Value _lastValue;
 };
 
 #endif
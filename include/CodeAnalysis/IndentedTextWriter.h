@@ -120,15 +120,15 @@ public:
         {
 
             SourceText text = diagnostic.Location.Text;
-            std::string Filename = diagnostic.Location.Filename;
-            int startLine = diagnostic.Location.StartLine + 1;
-            int startCharacter = diagnostic.Location.StartCharacter + 1;
-            int endLine = diagnostic.Location.EndLine + 1;
-            int endCharacter = diagnostic.Location.EndCharacter + 1;
+            std::string Filename = text.Filename();
+            int startLine = diagnostic.Location.StartLine() + 1;
+            int startCharacter = diagnostic.Location.StartCharacter() + 1;
+            int endLine = diagnostic.Location.EndLine() + 1;
+            int endCharacter = diagnostic.Location.EndCharacter() + 1;
 
             TextSpan span = diagnostic.Location.Span;
             int lineIndex = text.GetLineIndex(span.Start);
-            TextLine line = text._lines[lineIndex];
+            TextLine line = text.GetLine(lineIndex);
 
             WriteLine();
             SetForegroundColor(RED);
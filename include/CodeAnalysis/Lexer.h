@@ -9,7 +9,7 @@ class Lexer
 {
 public:
     Lexer(SyntaxTree *syntaxTree) : _syntaxTree(syntaxTree), input(syntaxTree->Text), pos(0), currentChar(input[0]), lookAhead(input[1]) {};
-    std::vector<Token> tokenize();
+    std::vector<SyntaxToken> tokenize();
     const DiagnosticBag &GetDiagnostics() const
     {
         return _diagnostics;
@@ -23,13 +23,14 @@ private:
     char currentChar;
     char lookAhead;
     void advance();
-    Token GenerateStringToken();
-    Token GenerateWhitespaceToken();
-    Token GenerateNumberToken();
-    Token GenerateIdentifierToken();
-    Token GenerateSingleLineComment();
-    Token GenerateMultiLineComment();
-    SyntaxKind checkKeyword(const std::string &keyword);
+    SyntaxToken MakeToken(SyntaxKind kind, size_t start, size_t length);
+    SyntaxToken GenerateStringToken();
+    SyntaxToken GenerateWhitespaceToken();
+    SyntaxToken GenerateNumberToken();
+    SyntaxToken GenerateIdentifierToken();
+    SyntaxToken GenerateSingleLineComment();
+    SyntaxToken GenerateMultiLineComment();
+    SyntaxKind checkKeyword(std::string_view keyword);
 };
 
 #endif
@@ -2,13 +2,21 @@
 #define LOWERER_H
 
 #include "CodeAnalysis/Binder.h"
+#include <map>
+#include <set>
 #include <stack>
+#include <unordered_set>
+// Rewriters return the node they were given when nothing under it changed,
+// so unchanged subtrees are shared. New nodes come from the given arena.
 class BoundTreeRewriter
 {
 public:
+    BoundTreeRewriter(Arena *arena) : _arena(arena) {}
     virtual BoundStatement *RewriteStatement(BoundStatement *node);
 
 protected:
+    Arena *_arena;
+
     virtual BoundStatement *RewriteBlockStatement(BoundBlockStatement *node);
     virtual BoundStatement *RewriteVariableDeclaration(BoundVariableDeclaration *node);
     virtual BoundStatement *RewriteIfStatement(BoundIfStatement *node);
@@ -17,6 +25,7 @@ protected:
     virtual BoundStatement *RewriteGotoStatement(BoundGotoStatement *node);
     virtual BoundStatement *RewriteLabelStatement(BoundLabelStatement *node);
     virtual BoundStatement *RewriteConditionalGotoStatement(BoundConditionalGotoStatement *node);
+    virtual BoundStatement *RewriteCountedGotoStatement(BoundCountedGotoStatement *node);
     virtual BoundStatement *RewriteExpressionStatement(BoundExpressionStatement *node);
     virtual BoundStatement *RewriteReturnStatement(BoundReturnStatement *node);
 
@@ -38,12 +47,14 @@ class Lowerer : public BoundTreeRewriter
 {
 public:
     int labelCount = 0;
+    int localCount = 0;
 
-    Lowerer() {}
+    Lowerer(Arena *arena) : BoundTreeRewriter(arena) {}
 
-    static BoundBlockStatement *Lower(BoundStatement *node);
-    static BoundBlockStatement *LowerEmitable(BoundStatement *node);
-    static BoundBlockStatement *Flatten(BoundStatement *node);
+    static BoundBlockStatement *Lower(Arena *arena, BoundStatement *node, int localCount = 0);
+    static BoundBlockStatement *LowerEmitable(Arena *arena, BoundStatement *node, int localCount = 0);
+    static BoundBlockStatement *Flatten(Arena *arena, BoundStatement *node);
+    static void ResolveLabels(BoundBlockStatement *block);
 
 protected:
     BoundStatement *RewriteIfStatement(BoundIfStatement *node) override;
@@ -53,4 +64,177 @@ protected:
 private:
     BoundLabel *GenerateLabel();
 };
+
+class ConstantFolder : public BoundTreeRewriter
+{
+public:
+    static BoundStatement *Fold(Arena *arena, BoundStatement *node);
+
+protected:
+    BoundStatement *RewriteVariableDeclaration(BoundVariableDeclaration *node) override;
+    BoundStatement *RewriteConditionalGotoStatement(BoundConditionalGotoStatement *node) override;
+
+    BoundExpression *RewriteVariableExpression(BoundVariableExpression *node) override;
+    BoundExpression *RewriteUnaryExpression(BoundUnaryExpression *node) override;
+    BoundExpression *RewriteBinaryExpression(BoundBinaryExpression *node) override;
+    BoundExpression *RewriteConversionExpression(BoundConversionExpression *node) override;
+
+private:
+    std::map<std::pair<SymbolKind, int>, BoundLiteralExpression *> _constants;
+
+    ConstantFolder(Arena *arena) : BoundTreeRewriter(arena) {}
+};
+
+class DeadCodeEliminator : public BoundTreeRewriter
+{
+public:
+    static BoundBlockStatement *Eliminate(Arena *arena, BoundBlockStatement *body);
+    BoundStatement *RewriteStatement(BoundStatement *node) override;
+
+protected:
+    BoundExpression *RewriteVariableExpression(BoundVariableExpression *node) override;
+
+private:
+    bool _collecting = false;
+    std::unordered_set<BoundStatement *> _live;
+    std::unordered_set<int> _readLocals;
+
+    DeadCodeEliminator(Arena *arena) : BoundTreeRewriter(arena) {}
+    bool IsDeadStore(const VariableSymbol &variable) const;
+};
+
+class LoopInvariantHoister : public BoundTreeRewriter
+{
+public:
+    static BoundBlockStatement *Hoist(Arena *arena, BoundBlockStatement *body, int &localCount);
+    BoundStatement *RewriteStatement(BoundStatement *node) override;
+
+protected:
+    BoundStatement *RewriteBlockStatement(BoundBlockStatement *node) override;
+    BoundExpression *RewriteExpression(BoundExpression *node) override;
+
+private:
+    struct Loop
+    {
+        std::unordered_set<BoundStatement *> Statements;
+        std::set<std::pair<SymbolKind, int>> Assigned;
+        std::set<std::pair<SymbolKind, int>> Stored;
+        bool HasCalls = false;
+        BoundStatement *Entry = nullptr;
+    };
+
+    struct Invariant
+    {
+        VariableSymbol Temporary;
+        const Loop *Owner;
+    };
+
+    std::vector<Loop> _loops;
+    std::vector<VariableSymbol> _temporaries;
+    std::unordered_map<BoundExpression *, Invariant> _invariants;
+    std::unordered_map<BoundStatement *, std::vector<BoundExpression *>> _preheaders;
+    BoundStatement *_current = nullptr;
+    int *_localCount = nullptr;
+
+    LoopInvariantHoister(Arena *arena) : BoundTreeRewriter(arena) {}
+    void FindLoops(BoundBlockStatement *flat);
+    bool IsInvariant(BoundExpression *node, const Loop &loop) const;
+    void Collect(BoundExpression *node, const Loop &loop);
+};
+
+class Inliner
+{
+public:
+    static void Inline(BoundProgram *program);
+
+private:
+    static const int StatementBudget = 24;
+
+    BoundProgram *_program;
+    Arena *_arena;
+    std::unordered_map<FunctionSymbol, std::vector<FunctionSymbol>> _callees;
+    std::unordered_set<FunctionSymbol> _recursive;
+    std::unordered_set<FunctionSymbol> _visited;
+    int _siteCount = 0;
+
+    Inliner(BoundProgram *program) : _program(program), _arena(&program->Nodes) {}
+
+    bool Reaches(const FunctionSymbol &from, const FunctionSymbol &to, std::unordered_set<FunctionSymbol> &seen);
+    BoundBlockStatement *GetInlinableBody(BoundExpression *node);
+    void Visit(const FunctionSymbol &function);
+    BoundBlockStatement *InlineCalls(BoundBlockStatement *body);
+    BoundExpression *Hoist(BoundExpression *node, bool &blocked, std::vector<BoundStatement *> &statements, int &localCount);
+    BoundExpression *Expand(BoundCallExpression *call, bool needsResult, std::vector<BoundStatement *> &statements, int &localCount);
+};
+
+class PurityAnalyzer : public BoundTreeRewriter
+{
+public:
+    static void Analyze(BoundProgram *program);
+
+protected:
+    BoundExpression *RewriteVariableExpression(BoundVariableExpression *node) override;
+    BoundExpression *RewriteAssignmentExpression(BoundAssignmentExpression *node) override;
+    BoundExpression *RewriteArrayAssignmentExpression(BoundArrayAssignmentExpression *node) override;
+    BoundExpression *RewriteCallExpression(BoundCallExpression *node) override;
+
+private:
+    bool _impure = false;
+    std::vector<FunctionSymbol> _callees;
+
+    PurityAnalyzer(Arena *arena) : BoundTreeRewriter(arena) {}
+};
+
+class CallLifter
+{
+public:
+    static BoundBlockStatement *Lift(Arena *arena, BoundBlockStatement *body);
+
+private:
+    Arena *_arena;
+    std::vector<BoundStatement *> _statements;
+    int _localCount = 0;
+    int _labelCount = 0;
+
+    CallLifter(Arena *arena) : _arena(arena) {}
+    static bool IsUserCall(BoundExpression *node);
+    static bool ContainsCall(BoundExpression *node);
+
+    BoundExpression *LiftExpression(BoundExpression *node);
+    std::vector<BoundExpression *> LiftOperands(const std::vector<BoundExpression *> &operands);
+    BoundCallExpression *LiftArguments(BoundCallExpression *node);
+    BoundExpression *Spill(BoundExpression *node);
+};
+
+class CallResolver : public BoundTreeRewriter
+{
+public:
+    static void Resolve(BoundProgram *program);
+
+protected:
+    BoundExpression *RewriteCallExpression(BoundCallExpression *node) override;
+
+private:
+    std::vector<BoundCallExpression *> _calls;
+
+    CallResolver(BoundProgram *program) : BoundTreeRewriter(&program->Nodes) {}
+    BoundBlockStatement *RewriteBody(BoundBlockStatement *body);
+};
+
+class ConstantPool : public BoundTreeRewriter
+{
+public:
+    static void Build(BoundProgram *program);
+    static Value Decode(BoundLiteralExpression *node);
+
+protected:
+    BoundExpression *RewriteLiteralExpression(BoundLiteralExpression *node) override;
+
+private:
+    std::vector<Value> _constants;
+    std::unordered_map<std::string, int> _indices;
+
+    ConstantPool(Arena *arena) : BoundTreeRewriter(arena) {}
+    BoundBlockStatement *RewriteBody(BoundBlockStatement *body);
+};
 #endif
\ No newline at end of file
@@ -26,7 +26,9 @@ private:
     SyntaxTree *_syntaxTree;
     SourceText _text;
     DiagnosticBag _diagnostics;
-    std::vector<Token> tokens;
+    // Tokens live on the tree; the ones past tokenCount were made up by
+    // Expect and are never read back by the parser.
+    size_t tokenCount;
     size_t currentTokenIndex;
     Token currentToken;
     Token peek(int offset);
@@ -1,7 +1,10 @@
 #ifndef SOURCE_TEXT_H
 #define SOURCE_TEXT_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 struct TextSpan
 {
@@ -29,26 +32,35 @@ struct TextSpan
 };
 
 class TextLine;
+
+// A handle to an immutable source buffer. Copies share the buffer, so tokens,
+// nodes and locations can hold one without copying the text.
 class SourceText
 {
 private:
-    std::string _text;
-    SourceText(const std::string &text, std::string filename = "")
-        : _text(text), Filename(filename)
+    struct Buffer
     {
-        _lines = ParseLines(text);
-    }
+        std::string Text;
+        std::string Filename;
+        std::vector<uint32_t> LineStarts;
+    };
+
+    std::shared_ptr<const Buffer> _buffer;
 
-    std::vector<TextLine> ParseLines(const std::string &text);
+    SourceText(const std::string &text, std::string filename = "");
 
-    static void AddLine(std::vector<TextLine> &result, const SourceText &sourceText, int position, int lineStart, int lineBreakWidth);
+    const Buffer &Data() const
+    {
+        static const Buffer empty{"", "", {0}};
+        return _buffer ? *_buffer : empty;
+    }
+
+    static std::vector<uint32_t> ParseLines(const std::string &text);
 
     static int GetLineBreakWidth(const std::string &text, int position);
 
 public:
     SourceText() {}
-    std::string Filename;
-    std::vector<TextLine> _lines;
     static SourceText From(const std::string &text, std::string filename = "")
     {
         return SourceText(text, filename);
@@ -56,24 +68,46 @@ public:
 
     char operator[](int index) const
     {
-        return _text[index];
+        return Data().Text[index];
     }
 
     int Length() const
     {
-        return static_cast<int>(_text.length());
+        return static_cast<int>(Data().Text.length());
+    }
+
+    const std::string &Filename() const
+    {
+        return Data().Filename;
+    }
+
+    int GetLineCount() const
+    {
+        return static_cast<int>(Data().LineStarts.size());
+    }
+
+    int GetLineStart(int index) const
+    {
+        return Data().LineStarts[index];
     }
 
+    TextLine GetLine(int index) const;
+
     int GetLineIndex(int position) const;
 
     std::string ToString() const
     {
-        return _text;
+        return Data().Text;
     }
 
     std::string ToString(int start, int length) const
     {
-        return _text.substr(start, length);
+        return Data().Text.substr(start, length);
+    }
+
+    std::string_view View(int start, int length) const
+    {
+        return std::string_view(Data().Text).substr(start, length);
     }
 
     std::string ToString(TextSpan span) const
@@ -106,19 +140,16 @@ public:
     }
 };
 
+// Line and character are worked out from the span when asked for, which is
+// only when a diagnostic gets printed.
 class TextLocation
 {
 public:
     SourceText Text;
     TextSpan Span;
     TextLocation(SourceText text, TextSpan span)
-        : Text(text), Span(span), Filename(text.Filename)
+        : Text(text), Span(span)
     {
-
-        StartLine = text.GetLineIndex(span.Start);
-        StartCharacter = span.Start - text._lines[StartLine].Start;
-        EndLine = text.GetLineIndex(span.End);
-        EndCharacter = span.End - text._lines[EndLine].Start;
     }
 
     TextLocation()
@@ -130,10 +161,24 @@ public:
         return Span.ToString();
     }
 
-    std::string Filename;
-    int StartLine;
-    int StartCharacter;
-    int EndLine;
-    int EndCharacter;
+    int StartLine() const
+    {
+        return Text.GetLineIndex(Span.Start);
+    }
+
+    int StartCharacter() const
+    {
+        return Span.Start - Text.GetLineStart(StartLine());
+    }
+
+    int EndLine() const
+    {
+        return Text.GetLineIndex(Span.End);
+    }
+
+    int EndCharacter() const
+    {
+        return Span.End - Text.GetLineStart(EndLine());
+    }
 };
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/IndentedTextWriter.h"
+#include "CodeAnalysis/Value.h"
 enum class SymbolKind
 {
     Variable,
@@ -32,14 +33,31 @@ public:
 
 protected:
     Symbol(std::string name) : Name(name) {}
+
+    // Variables and functions get a fresh id when they are declared; copies
+    // share it, so shadowing symbols with the same name stay distinct.
+    static int NextId()
+    {
+        static int nextId = 0;
+        return ++nextId;
+    }
 };
 
+// Types are interned: every TypeSymbol is a copy of one of the statics
+// below, so equality and array checks compare the ids they were given at
+// construction. Id 0 is never assigned.
 class TypeSymbol : public Symbol
 {
 private:
-    TypeSymbol(std::string name) : Symbol(name) {}
+    TypeSymbol(std::string name, const TypeSymbol *elementType = nullptr) : Symbol(name), Id(Register(this)), ElementId(elementType == nullptr ? 0 : elementType->Id) {}
+
+    static std::vector<const TypeSymbol *> &Registry();
+    static int Register(const TypeSymbol *type);
 
 public:
+    int Id;
+    int ElementId;
+
     static const TypeSymbol Integer;
     static const TypeSymbol Float;
     static const TypeSymbol Boolean;
@@ -65,11 +83,15 @@ public:
     }
     bool IsArray() const
     {
-        return Name.find("array") != std::string::npos;
+        return ElementId != 0;
+    }
+    const TypeSymbol &ElementType() const
+    {
+        return *Registry()[ElementId];
     }
     bool operator==(const TypeSymbol &other) const
     {
-        return Name == other.Name;
+        return Id == other.Id;
     }
 
     bool operator!=(const TypeSymbol &other) const
@@ -83,6 +105,18 @@ public:
     }
 };
 
+namespace std
+{
+    template <>
+    struct hash<TypeSymbol>
+    {
+        std::size_t operator()(const TypeSymbol &symbol) const
+        {
+            return std::hash<int>()(symbol.Id);
+        }
+    };
+}
+
 class VariableSymbol : Symbol
 {
 public:
@@ -91,9 +125,11 @@ public:
     bool IsReadOnly;
     SymbolKind Kind;
     int Size = -1;
+    int Slot = -1;
+    int Id = 0;
     VariableSymbol() : Symbol(""), IsReadOnly(false), Type(TypeSymbol::Error) {}
-    VariableSymbol(std::string name, bool isReadOnly, TypeSymbol type) : Symbol(name), Name(name), IsReadOnly(isReadOnly), Type(type) {}
-    VariableSymbol(SymbolKind kind, std::string name, bool isReadOnly, TypeSymbol type) : Symbol(name), Name(name), IsReadOnly(isReadOnly), Type(type), Kind(kind) {}
+    VariableSymbol(std::string name, bool isReadOnly, TypeSymbol type) : Symbol(name), Name(name), IsReadOnly(isReadOnly), Type(type), Id(NextId()) {}
+    VariableSymbol(SymbolKind kind, std::string name, bool isReadOnly, TypeSymbol type) : Symbol(name), Name(name), IsReadOnly(isReadOnly), Type(type), Kind(kind), Id(NextId()) {}
     SymbolKind GetKind() const override
     {
         return Kind;
@@ -106,7 +142,7 @@ public:
 
     bool operator==(const VariableSymbol &other) const
     {
-        return Name == other.Name;
+        return Id == other.Id;
     }
 
     std::string ToString() const
@@ -122,7 +158,7 @@ namespace std
     {
         std::size_t operator()(const VariableSymbol &symbol) const
         {
-            return std::hash<std::string>()(symbol.ToString());
+            return std::hash<int>()(symbol.Id);
         }
     };
 }
@@ -168,11 +204,13 @@ public:
         return SymbolKind::Function;
     }
 
-    FunctionSymbol(std::string name, std::vector<ParameterSymbol> parameters, TypeSymbol type, FunctionDeclarationSyntax *declaration = nullptr) : Symbol(name), Parameters(parameters), Type(type), Declaration(declaration) {}
+    FunctionSymbol(std::string name, std::vector<ParameterSymbol> parameters, TypeSymbol type, FunctionDeclarationSyntax *declaration = nullptr) : Symbol(name), Parameters(parameters), Type(type), Declaration(declaration), Id(NextId()) {}
     FunctionSymbol() : Symbol(""), Parameters({}), Type(TypeSymbol::Error), Declaration(nullptr) {};
     std::vector<ParameterSymbol> Parameters;
     TypeSymbol Type;
     FunctionDeclarationSyntax *Declaration = nullptr;
+    int Id = 0;
+    int BuiltIn = -1;
     friend std::ostream &operator<<(std::ostream &os, const FunctionSymbol &func)
     {
         os << "FunctionSymbol(Name: " << func.Name << ")";
@@ -186,7 +224,7 @@ public:
 
     bool operator==(const FunctionSymbol &other) const
     {
-        return Name == other.Name;
+        return Id == other.Id;
     }
 };
 
@@ -197,11 +235,23 @@ namespace std
     {
         std::size_t operator()(const FunctionSymbol &symbol) const
         {
-            return std::hash<std::string>()(symbol.ToString());
+            return std::hash<int>()(symbol.Id);
         }
     };
 }
 
+using BuiltInHandler = Value (*)(const Value *arguments);
+
+// Template is the C++ that cyc emits for a call, with $0, $1, ... standing
+// for the arguments. Pure builtins neither read nor change outside state.
+struct BuiltInFunction
+{
+    FunctionSymbol Function;
+    BuiltInHandler Handler;
+    std::string Template;
+    bool IsPure;
+};
+
 class BuiltInFunctions
 {
 public:
@@ -210,10 +260,7 @@ public:
     static const FunctionSymbol Random;
     static const FunctionSymbol ArrayLength;
     static const FunctionSymbol StringLength;
-    static std::vector<FunctionSymbol> GetAll()
-    {
-        return {Print, Input, Random, ArrayLength, StringLength};
-    }
+    static const std::vector<BuiltInFunction> &GetAll();
 };
 
 class SymbolPrinter
@@ -1,11 +1,14 @@
 #ifndef SYNTAX_TREE_H
 #define SYNTAX_TREE_H
 
+#include "CodeAnalysis/Arena.h"
 #include "CodeAnalysis/Diagnostic.h"
 #include "CodeAnalysis/SourceText.h"
 
 #include <vector>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <any>
 
 enum class SyntaxKind
@@ -97,22 +100,47 @@ class CompilationUnitNode;
 
 class Token;
 
+// What the lexer produces: a kind and a span into the source. String
+// literals with escapes keep their decoded text in SyntaxTree::Literals.
+struct SyntaxToken
+{
+    SyntaxKind Kind;
+    uint32_t Start;
+    uint32_t Length;
+    int32_t Literal = -1;
+};
+
 class SyntaxTree
 {
 public:
     SourceText Text;
+    std::vector<SyntaxToken> Tokens;
+    std::deque<std::string> Literals;
     std::vector<Diagnostic> Diagnostics;
     CompilationUnitNode *Root;
-    static SyntaxTree Parse(std::string text);
-    static SyntaxTree Parse(SourceText text);
+    SyntaxTree(const SyntaxTree &) = delete;
+    SyntaxTree &operator=(const SyntaxTree &) = delete;
+
+    static SyntaxTree *Parse(std::string text);
+    static SyntaxTree *Parse(SourceText text);
     static void Parse(SyntaxTree *syntaxTree, CompilationUnitNode *&root, std::vector<Diagnostic> &diagnostics);
     static std::vector<Token> ParseTokens(std::string text);
     static std::vector<Token> ParseTokens(std::string text, std::vector<Diagnostic> &diagnostics);
     static std::vector<Token> ParseTokens(SourceText text);
     static std::vector<Token> ParseTokens(SourceText text, std::vector<Diagnostic> &diagnostics);
-    static SyntaxTree Load(std::string filename);
+    static SyntaxTree *Load(std::string filename);
+
+    std::string_view GetText(const SyntaxToken &token) const;
+
+    // Nodes and separators live in the tree's arena and go away with it.
+    template <typename T, typename... Args>
+    T *Create(Args &&...args)
+    {
+        return _nodes.New<T>(std::forward<Args>(args)...);
+    }
 
 private:
+    Arena _nodes;
     using ParseHandler = void (*)(SyntaxTree *syntaxTree, CompilationUnitNode *&root, std::vector<Diagnostic> &diagnostics);
     SyntaxTree(SourceText text, ParseHandler handler);
 };
@@ -123,7 +151,6 @@ public:
     virtual ~SyntaxNode() = default;
     SyntaxTree *syntaxTree;
     SyntaxKind Kind;
-    TextLocation Location;
     virtual std::vector<SyntaxNode *> GetChildren() const
     {
         return {};
@@ -142,9 +169,9 @@ public:
         return TextSpan::FromBounds(start, end);
     }
 
-    void InitializeLocation()
+    TextLocation GetLocation() const
     {
-        Location = TextLocation(syntaxTree->Text, Span());
+        return TextLocation(syntaxTree->Text, Span());
     }
     void WriteTo(std::ostream &os)
     {
@@ -176,32 +203,33 @@ private:
 class Token : public SyntaxNode
 {
 public:
-    std::string value;
-    size_t position;
-    TextSpan span;
+    int Index;
 
-    Token(SyntaxTree *syntaxTree, SyntaxKind kind, std::string value, size_t position) : SyntaxNode(syntaxTree, kind), value(value), position(position), span(TextSpan(position, value.empty() ? 0 : value.size()))
+    Token(SyntaxTree *syntaxTree, int index) : SyntaxNode(syntaxTree, syntaxTree->Tokens[index].Kind), Index(index)
     {
-        InitializeLocation();
     }
-    Token(SyntaxTree *syntaxTree) : SyntaxNode(syntaxTree, SyntaxKind::BAD_TOKEN), span(TextSpan(0, 0))
+    Token(SyntaxTree *syntaxTree) : SyntaxNode(syntaxTree, SyntaxKind::BAD_TOKEN), Index(-1)
     {
-        InitializeLocation();
     };
-    Token(SyntaxTree *syntaxtree, const Token &other)
-        : SyntaxNode(syntaxtree, other.Kind), value(other.value), position(other.position), span(other.span)
+
+    std::string_view Text() const
     {
-        InitializeLocation();
+        if (Index < 0)
+            return {};
+        return syntaxTree->GetText(syntaxTree->Tokens[Index]);
     }
 
     TextSpan Span() const override
     {
-        return span;
+        if (Index < 0)
+            return TextSpan(0, 0);
+        const SyntaxToken &token = syntaxTree->Tokens[Index];
+        return TextSpan(token.Start, token.Length);
     }
 
     bool operator==(const Token &other) const
     {
-        return Kind == other.Kind && value == other.value && position == other.position;
+        return syntaxTree == other.syntaxTree && Index == other.Index;
     }
 
     std::vector<SyntaxNode *> GetChildren() const override
@@ -312,10 +340,9 @@ public:
     TypeClauseNode(SyntaxTree *syntaxTree, Token ColonToken, Token IdentifierToken, bool isArray = false, SyntaxNode *size = nullptr)
         : SyntaxNode(syntaxTree, SyntaxKind::TypeClause), ColonToken(ColonToken), IdentifierToken(IdentifierToken), IsArray(isArray), Size(size)
     {
-        InitializeLocation();
         if (isArray)
         {
-            ElementType = new TypeClauseNode(syntaxTree, ColonToken, IdentifierToken);
+            ElementType = syntaxTree->Create<TypeClauseNode>(syntaxTree, ColonToken, IdentifierToken);
         }
     }
 
@@ -336,7 +363,6 @@ public:
     VariableDeclarationSyntax(SyntaxTree *syntaxTree, Token keyword, Token identifier, TypeClauseNode *typeClause, Token equalsToken, SyntaxNode *initializer)
         : StatementSyntax(syntaxTree, SyntaxKind::VariableDeclaration), Keyword(keyword), Identifier(identifier), TypeClause(typeClause), EqualsToken(equalsToken), Initializer(initializer)
     {
-        InitializeLocation();
     }
     Token Identifier;
     Token EqualsToken;
@@ -368,7 +394,6 @@ public:
     ArrayInitializerSyntax(SyntaxTree *syntaxTree, Token openBraceToken, SeparatedSyntaxList<SyntaxNode> initializers, Token closeBraceToken)
         : SyntaxNode(syntaxTree, SyntaxKind::ArrayInitializer), OpenBraceToken(openBraceToken), Elements(initializers), CloseBraceToken(closeBraceToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -392,7 +417,6 @@ public:
     ArrayAccessExpressionSyntax(SyntaxTree *syntaxTree, SyntaxNode *identifier, Token openBracketToken, SyntaxNode *index, Token closeBracketToken)
         : SyntaxNode(syntaxTree, SyntaxKind::ArrayAccessExpression), Identifier(identifier), OpenBracketToken(openBracketToken), Index(index), CloseBracketToken(closeBracketToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -419,7 +443,6 @@ public:
     ArrayAssignmentExpressionSyntax(SyntaxTree *syntaxTree, SyntaxNode *identifier, Token openBracketToken, SyntaxNode *index, Token closeBracketToken, Token equalsToken, SyntaxNode *right)
         : SyntaxNode(syntaxTree, SyntaxKind::ArrayAssignmentExpression), Identifier(identifier), OpenBracketToken(openBracketToken), Index(index), CloseBracketToken(closeBracketToken), EqualsToken(equalsToken), Expression(right)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -438,7 +461,6 @@ public:
     ExpressionStatementSyntax(SyntaxTree *syntaxTree, SyntaxNode *expression)
         : StatementSyntax(syntaxTree, SyntaxKind::ExpressionStatement), Expression(expression)
     {
-        InitializeLocation();
     }
     SyntaxNode *Expression;
 
@@ -457,7 +479,6 @@ public:
     BlockStatementSyntax(SyntaxTree *syntaxTree, Token openBraceToken, std::vector<StatementSyntax *> statements, Token closeBraceToken)
         : StatementSyntax(syntaxTree, SyntaxKind::BlockStatement), OpenBraceToken(openBraceToken), Statements(statements), CloseBraceToken(closeBraceToken)
     {
-        InitializeLocation();
     }
     Token OpenBraceToken;
     std::vector<StatementSyntax *> Statements;
@@ -486,7 +507,6 @@ public:
     ForStatementSyntax(SyntaxTree *syntaxTree, Token keyword, Token identifier, Token equalsToken, SyntaxNode *lowerBound, Token toKeyword, SyntaxNode *upperBound, StatementSyntax *body)
         : StatementSyntax(syntaxTree, SyntaxKind::ForStatement), Keyword(keyword), Identifier(identifier), EqualsToken(equalsToken), LowerBound(lowerBound), ToKeyword(toKeyword), UpperBound(upperBound), Body(body)
     {
-        InitializeLocation();
     }
     Token Keyword;
     Token Identifier;
@@ -513,7 +533,6 @@ public:
     BreakStatementSyntax(SyntaxTree *syntaxTree, Token keyword)
         : StatementSyntax(syntaxTree, SyntaxKind::BreakStatement), Keyword(keyword)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -534,7 +553,6 @@ public:
     ContinueStatementSyntax(SyntaxTree *syntaxTree, Token keyword)
         : StatementSyntax(syntaxTree, SyntaxKind::ContinueStatement), Keyword(keyword)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -556,7 +574,6 @@ public:
     ReturnStatementSyntax(SyntaxTree *syntaxTree, Token keyword, SyntaxNode *expression)
         : StatementSyntax(syntaxTree, SyntaxKind::ReturnStatement), Keyword(keyword), Expression(expression)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -579,7 +596,6 @@ public:
     ElseClauseSyntax(SyntaxTree *syntaxTree, Token elseKeyword, StatementSyntax *elseStatement)
         : SyntaxNode(syntaxTree, SyntaxKind::ElseClause), ElseKeyword(elseKeyword), ElseStatement(elseStatement)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -601,7 +617,6 @@ public:
     IfStatementSyntax(SyntaxTree *syntaxTree, Token ifkeyword, SyntaxNode *condition, StatementSyntax *thenStatement, ElseClauseSyntax *elseClause)
         : StatementSyntax(syntaxTree, SyntaxKind::IfStatement), IfKeyword(ifkeyword), Condition(condition), ThenStatement(thenStatement), ElseClause(elseClause)
     {
-        InitializeLocation();
     }
     Token IfKeyword;
     SyntaxNode *Condition;
@@ -633,7 +648,6 @@ public:
     WhileStatementSyntax(SyntaxTree *syntaxTree, Token whileKeyword, SyntaxNode *condition, StatementSyntax *body)
         : StatementSyntax(syntaxTree, SyntaxKind::WhileStatement), WhileKeyword(whileKeyword), Condition(condition), Body(body)
     {
-        InitializeLocation();
     }
     Token WhileKeyword;
     SyntaxNode *Condition;
@@ -654,7 +668,6 @@ class MemberSyntax : public SyntaxNode
 public:
     MemberSyntax(SyntaxTree *syntaxTree, SyntaxKind kind) : SyntaxNode(syntaxTree, kind)
     {
-        InitializeLocation();
     }
 
     virtual std::vector<SyntaxNode *> GetChildren() const override
@@ -668,7 +681,6 @@ public:
     GlobalStatementSyntax(SyntaxTree *syntaxTree, StatementSyntax *statement)
         : MemberSyntax(syntaxTree, SyntaxKind::GlobalStatement), Statement(statement)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -691,7 +703,6 @@ public:
     ParameterNode(SyntaxTree *syntaxTree, Token IdentifierToken, TypeClauseNode *Type)
         : SyntaxNode(syntaxTree, SyntaxKind::Parameter), IdentifierToken(IdentifierToken), Type(Type)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -711,7 +722,6 @@ public:
     FunctionDeclarationSyntax(SyntaxTree *syntaxTree, Token functionKeyword, Token identifier, Token openParenthesisToken, SeparatedSyntaxList<ParameterNode> parameters, Token closeParenthesisToken, TypeClauseNode *type, BlockStatementSyntax *body)
         : MemberSyntax(syntaxTree, SyntaxKind::FunctionDeclaration), FunctionKeyword(functionKeyword), Identifier(identifier), OpenParenthesisToken(openParenthesisToken), Parameters(parameters), CloseParenthesisToken(closeParenthesisToken), Type(type), Body(body)
     {
-        InitializeLocation();
     }
     Token FunctionKeyword;
     Token Identifier;
@@ -755,7 +765,6 @@ public:
     CompilationUnitNode(SyntaxTree *syntaxTree, std::vector<MemberSyntax *> members, Token endOfFileToken)
         : SyntaxNode(syntaxTree, SyntaxKind::CompilationUnit), Members(members), EndOfFileToken(endOfFileToken)
     {
-        InitializeLocation();
     }
 
     std::vector<MemberSyntax *> Members;
@@ -790,13 +799,11 @@ public:
     LiteralExpressionNode(SyntaxTree *syntaxTree, Token LiteralToken, std::any Value)
         : SyntaxNode(syntaxTree, SyntaxKind::LiteralExpression), LiteralToken(LiteralToken), Value(Value)
     {
-        InitializeLocation();
     }
 
     LiteralExpressionNode(SyntaxTree *syntaxTree, Token LiteralToken)
-        : SyntaxNode(syntaxTree, SyntaxKind::LiteralExpression), LiteralToken(LiteralToken), Value(LiteralToken.value)
+        : SyntaxNode(syntaxTree, SyntaxKind::LiteralExpression), LiteralToken(LiteralToken), Value(std::string(LiteralToken.Text()))
     {
-        InitializeLocation();
     }
     TextSpan Span() const override
     {
@@ -815,7 +822,6 @@ public:
     NameExpressionNode(SyntaxTree *syntaxTree, Token IdentifierToken)
         : SyntaxNode(syntaxTree, SyntaxKind::NameExpression), IdentifierToken(IdentifierToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -837,7 +843,6 @@ public:
     AssignmentExpressionNode(SyntaxTree *syntaxTree, Token IdentifierToken, Token EqualsToken, SyntaxNode *Expression)
         : SyntaxNode(syntaxTree, SyntaxKind::AssignmentExpression), IdentifierToken(IdentifierToken), EqualsToken(EqualsToken), Expression(Expression)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -859,7 +864,6 @@ public:
     BinaryExpressionNode(SyntaxTree *syntaxTree, SyntaxNode *left, SyntaxNode *right, Token OperatorToken)
         : SyntaxNode(syntaxTree, SyntaxKind::BinaryExpression), left(left), right(right), OperatorToken(OperatorToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -880,7 +884,6 @@ public:
     ParenthesizedExpressionNode(SyntaxTree *syntaxTree, SyntaxNode *expression)
         : SyntaxNode(syntaxTree, SyntaxKind::ParenthesizedExpression), expression(expression)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -901,7 +904,6 @@ public:
     UnaryExpressionNode(SyntaxTree *syntaxTree, SyntaxNode *expression, Token OperatorToken)
         : SyntaxNode(syntaxTree, SyntaxKind::UnaryExpression), expression(expression), OperatorToken(OperatorToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
@@ -924,7 +926,6 @@ public:
     CallExpressionNode(SyntaxTree *syntaxTree, Token IdentifierToken, Token OpenParenthesisToken, SeparatedSyntaxList<SyntaxNode> Arguments, Token CloseParenthesisToken)
         : SyntaxNode(syntaxTree, SyntaxKind::CallExpression), IdentifierToken(IdentifierToken), OpenParenthesisToken(OpenParenthesisToken), Arguments(Arguments), CloseParenthesisToken(CloseParenthesisToken)
     {
-        InitializeLocation();
     }
 
     TextSpan Span() const override
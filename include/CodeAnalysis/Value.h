@@ -0,0 +1,258 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class ValueKind : uint8_t
+{
+    None,
+    Integer,
+    Float,
+    Boolean,
+    String,
+    Array,
+};
+
+class Value;
+
+// Strings and arrays live on the heap behind a reference count so that a
+// Value stays 16 bytes and copying one never copies the payload.
+class HeapObject
+{
+public:
+    int RefCount = 1;
+};
+
+class StringObject : public HeapObject
+{
+public:
+    StringObject(std::string text) : Text(std::move(text)) {}
+    std::string Text;
+};
+
+// Integer, Float and Boolean arrays are stored unboxed in the matching
+// vector. Every other array (ElementKind None) boxes its elements in
+// Elements; a typed array falls back to that form if it is handed a value
+// of another kind through array<any>.
+class ArrayObject : public HeapObject
+{
+public:
+    ArrayObject(std::vector<Value> elements);
+    ArrayObject(ValueKind elementKind, const Value *elements, size_t count);
+
+    ValueKind ElementKind = ValueKind::None;
+    std::vector<long long> Integers;
+    std::vector<double> Floats;
+    std::vector<uint8_t> Booleans;
+    std::vector<Value> Elements;
+
+    size_t Size() const;
+    Value Get(size_t index) const;
+    void Set(size_t index, const Value &value);
+
+private:
+    void Box();
+};
+
+class Value
+{
+public:
+    Value() : _kind(ValueKind::None), _integer(0) {}
+    Value(int value) : _kind(ValueKind::Integer), _integer(value) {}
+    Value(long long value) : _kind(ValueKind::Integer), _integer(value) {}
+    Value(double value) : _kind(ValueKind::Float), _float(value) {}
+    Value(bool value) : _kind(ValueKind::Boolean), _integer(0) { _boolean = value; }
+    Value(const char *value) : _kind(ValueKind::String), _string(new StringObject(value)) {}
+    Value(std::string value) : _kind(ValueKind::String), _string(new StringObject(std::move(value))) {}
+    Value(std::vector<Value> elements);
+    Value(ValueKind elementKind, const Value *elements, size_t count);
+
+    Value(const Value &other) : _kind(other._kind), _integer(other._integer)
+    {
+        Retain();
+    }
+
+    Value(Value &&other) noexcept : _kind(other._kind), _integer(other._integer)
+    {
+        other._kind = ValueKind::None;
+    }
+
+    Value &operator=(const Value &other)
+    {
+        if (this != &other)
+        {
+            other.Retain();
+            Release();
+            _kind = other._kind;
+            _integer = other._integer;
+        }
+        return *this;
+    }
+
+    Value &operator=(Value &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            _kind = other._kind;
+            _integer = other._integer;
+            other._kind = ValueKind::None;
+        }
+        return *this;
+    }
+
+    ~Value()
+    {
+        Release();
+    }
+
+    ValueKind GetKind() const { return _kind; }
+    bool HasValue() const { return _kind != ValueKind::None; }
+    bool IsInteger() const { return _kind == ValueKind::Integer; }
+    bool IsFloat() const { return _kind == ValueKind::Float; }
+    bool IsBoolean() const { return _kind == ValueKind::Boolean; }
+    bool IsString() const { return _kind == ValueKind::String; }
+    bool IsArray() const { return _kind == ValueKind::Array; }
+
+    long long AsInteger() const { return _integer; }
+    double AsFloat() const { return _float; }
+    bool AsBoolean() const { return _boolean; }
+    const std::string &AsString() const { return _string->Text; }
+    const ArrayObject &AsArray() const { return *_array; }
+
+    // Copy-on-write access for in-place updates: the payload is cloned first
+    // when another Value still shares it.
+    std::string &MutableString();
+    ArrayObject &MutableArray();
+
+    // Numeric view used by mixed int/float arithmetic.
+    double AsNumber() const
+    {
+        return _kind == ValueKind::Integer ? static_cast<double>(_integer) : _float;
+    }
+
+    // Matches the text produced by Cyclone's string() conversion.
+    std::string ToString() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const Value &value);
+
+private:
+    ValueKind _kind;
+    union
+    {
+        long long _integer;
+        double _float;
+        bool _boolean;
+        StringObject *_string;
+        ArrayObject *_array;
+    };
+
+    void Retain() const
+    {
+        if (_kind == ValueKind::String)
+            _string->RefCount++;
+        else if (_kind == ValueKind::Array)
+            _array->RefCount++;
+    }
+
+    void Release()
+    {
+        if (_kind == ValueKind::String)
+        {
+            if (--_string->RefCount == 0)
+                delete _string;
+        }
+        else if (_kind == ValueKind::Array)
+        {
+            if (--_array->RefCount == 0)
+                delete _array;
+        }
+    }
+};
+
+static_assert(sizeof(Value) == 16, "Value must stay a 16 byte tagged union");
+
+inline ArrayObject::ArrayObject(std::vector<Value> elements) : Elements(std::move(elements)) {}
+
+inline size_t ArrayObject::Size() const
+{
+    switch (ElementKind)
+    {
+    case ValueKind::Integer:
+        return Integers.size();
+    case ValueKind::Float:
+        return Floats.size();
+    case ValueKind::Boolean:
+        return Booleans.size();
+    default:
+        return Elements.size();
+    }
+}
+
+inline Value ArrayObject::Get(size_t index) const
+{
+    switch (ElementKind)
+    {
+    case ValueKind::Integer:
+        return Value(Integers[index]);
+    case ValueKind::Float:
+        return Value(Floats[index]);
+    case ValueKind::Boolean:
+        return Value(Booleans[index] != 0);
+    default:
+        return Elements[index];
+    }
+}
+
+inline void ArrayObject::Set(size_t index, const Value &value)
+{
+    if (ElementKind != ValueKind::None && value.GetKind() != ElementKind)
+        Box();
+
+    switch (ElementKind)
+    {
+    case ValueKind::Integer:
+        Integers[index] = value.AsInteger();
+        break;
+    case ValueKind::Float:
+        Floats[index] = value.AsFloat();
+        break;
+    case ValueKind::Boolean:
+        Booleans[index] = value.AsBoolean();
+        break;
+    default:
+        Elements[index] = value;
+        break;
+    }
+}
+
+inline Value::Value(std::vector<Value> elements) : _kind(ValueKind::Array), _array(new ArrayObject(std::move(elements))) {}
+
+inline Value::Value(ValueKind elementKind, const Value *elements, size_t count) : _kind(ValueKind::Array), _array(new ArrayObject(elementKind, elements, count)) {}
+
+inline std::string &Value::MutableString()
+{
+    if (_string->RefCount > 1)
+    {
+        _string->RefCount--;
+        _string = new StringObject(_string->Text);
+    }
+    return _string->Text;
+}
+
+inline ArrayObject &Value::MutableArray()
+{
+    if (_array->RefCount > 1)
+    {
+        _array->RefCount--;
+        _array = new ArrayObject(*_array);
+        _array->RefCount = 1;
+    }
+    return *_array;
+}
+
+#endif
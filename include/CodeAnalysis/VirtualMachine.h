@@ -0,0 +1,149 @@
+#ifndef VIRTUALMACHINE_H
+#define VIRTUALMACHINE_H
+
+#include "CodeAnalysis/Binder.h"
+#include "CodeAnalysis/Evaluator.h"
+#include "CodeAnalysis/Value.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Register bytecode. Unless noted otherwise A is the destination register,
+// B and C are source registers. Registers are relative to the frame base.
+enum class OpCode : uint8_t
+{
+    Move,         // R[A] = R[B]
+    LoadConstant, // R[A] = Constants[B]
+    LoadGlobal,   // R[A] = Globals[B]
+    StoreGlobal,  // Globals[B] = R[A]
+
+    AddInt,
+    SubtractInt,
+    MultiplyInt,
+    DivideInt,
+    EqualsInt,
+    NotEqualsInt,
+    LessInt,
+    LessOrEqualsInt,
+    GreaterInt,
+    GreaterOrEqualsInt,
+    Binary,  // R[A] = BinaryHandlers[Kind](R[B], R[C])
+    Unary,   // R[A] = UnaryHandlers[Kind](R[B])
+    Convert, // R[A] = (Types[C]) R[B]
+
+    Jump,        // pc = A
+    JumpIfTrue,  // if R[B] pc = A
+    JumpIfFalse, // if !R[B] pc = A
+    ForLoop,       // R[B] = R[B] + 1; if R[B] <= R[C] pc = A
+    ForLoopGlobal, // Globals[B] = Globals[B] + 1; if Globals[B] <= R[C] pc = A
+
+    Call,        // R[A] = Functions[B](R[C], R[C + 1], ...)
+    CallBuiltIn, // R[A] = BuiltIns[B](R[C], R[C + 1], ...)
+    Return,      // return R[A], or nothing when A < 0
+
+    NewArray,       // R[A] = <Kind>[R[B], ..., R[B + C - 1]]
+    Index,          // R[A] = R[B][R[C]]
+    SetIndex,       // R[A][R[B]] = R[C]
+    IndexGlobal,    // R[A] = Globals[B][R[C]]
+    SetGlobalIndex, // Globals[A][R[B]] = R[C]
+};
+
+struct Instruction
+{
+    OpCode Op;
+    uint8_t Kind = 0;
+    int32_t A = 0;
+    int32_t B = 0;
+    int32_t C = 0;
+};
+
+class BytecodeFunction
+{
+public:
+    std::string Name;
+    int ParameterCount = 0;
+    int RegisterCount = 0;
+    std::vector<Instruction> Code;
+};
+
+class BytecodeProgram
+{
+public:
+    std::vector<BytecodeFunction> Functions;
+    int EntryPoint = 0;
+    std::vector<Value> Constants;
+    std::vector<VariableSymbol> Globals;
+    int GlobalCount = 0;
+    std::vector<TypeSymbol> Types;
+    std::vector<BinaryOperatorHandler> BinaryHandlers;
+    std::vector<UnaryOperatorHandler> UnaryHandlers;
+};
+
+class BytecodeCompiler
+{
+public:
+    static std::unique_ptr<BytecodeProgram> Compile(BoundProgram *program);
+
+private:
+    BytecodeCompiler(BytecodeProgram *output) : _output(output) {}
+
+    BytecodeProgram *_output;
+    std::unordered_map<FunctionSymbol, int> _functionIndices;
+
+    BytecodeFunction *_function = nullptr;
+    std::vector<int> _statementOffsets;
+    std::vector<std::pair<int, int>> _fixups;
+    int _localCount = 0;
+    int _nextRegister = 0;
+    int _resultRegister = -1;
+    int _statementResult = -1;
+
+    void CompileFunction(BytecodeFunction &function, int parameterCount, BoundBlockStatement *body, bool isEntryPoint);
+    void CompileStatement(BoundStatement *node);
+    int CompileExpression(BoundExpression *node, int target = -1);
+    int CompileLogicalExpression(BoundBinaryExpression *node, int target);
+    int CompileCallExpression(BoundCallExpression *node, int target);
+    int CompileArrayAssignmentExpression(BoundArrayAssignmentExpression *node, int target);
+    int CompileAssignment(const VariableSymbol &variable, BoundExpression *expression, int target);
+
+    int Emit(OpCode op, int a = 0, int b = 0, int c = 0, uint8_t kind = 0);
+    int AllocateRegister();
+    int AllocateRegisters(int count);
+    int Destination(int target);
+    int LocalRegister(const VariableSymbol &variable);
+    int GlobalIndex(const VariableSymbol &variable);
+    int ConstantIndex(BoundLiteralExpression *node);
+    int AddConstant(Value value);
+    int TypeIndex(const TypeSymbol &type);
+    int HandlerIndex(BinaryOperatorHandler handler);
+    int HandlerIndex(UnaryOperatorHandler handler);
+};
+
+class VirtualMachine
+{
+public:
+    VirtualMachine(BytecodeProgram *program, std::unordered_map<VariableSymbol, Value> &variables, size_t stackLimit = Evaluator::DefaultStackLimit) : _program(program), _variables(variables), _stackLimit(stackLimit) {}
+    Value Run();
+
+private:
+    struct Frame
+    {
+        const BytecodeFunction *Function;
+        size_t Base;
+        size_t ReturnRegister;
+        const Instruction *Pc;
+    };
+
+    BytecodeProgram *_program;
+    std::unordered_map<VariableSymbol, Value> &_variables;
+    std::vector<Value> _registers;
+    std::vector<Value> _globals;
+    std::vector<Frame> _frames;
+    size_t _stackLimit;
+
+    Value Execute();
+    void EnsureRegisters(size_t count);
+};
+
+#endif
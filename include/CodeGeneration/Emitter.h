@@ -2,15 +2,16 @@
 #define EMITTER_H
 
 #include "CodeAnalysis/Binder.h"
+#include "CodeAnalysis/Value.h"
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
 class Emitter
 {
 public:
-    Emitter(std::string filename, BoundProgram *program, std::unordered_map<VariableSymbol, std::any> &variables) : _program(program), _globals(variables), Filename(filename)
+    Emitter(std::string filename, BoundProgram *program, std::unordered_map<VariableSymbol, Value> &variables) : _program(program), _globals(variables), Filename(filename)
     {
-        _locals.push(std::unordered_map<VariableSymbol, std::any>());
+        _locals.push(std::unordered_map<VariableSymbol, Value>());
     }
     void Emit();
 
@@ -18,8 +19,8 @@ private:
     BoundProgram *_program;
     std::string Filename;
     std::ofstream codeStream;
-    std::unordered_map<VariableSymbol, std::any> &_globals;
-    std::stack<std::unordered_map<VariableSymbol, std::any>> _locals;
+    std::unordered_map<VariableSymbol, Value> &_globals;
+    std::stack<std::unordered_map<VariableSymbol, Value>> _locals;
 
     void EmitIncludes();
     void EmitFunctions();
@@ -28,6 +29,7 @@ private:
     void EmitExpressionStatement(BoundExpressionStatement *node);
     void EmitGotoStatement(BoundGotoStatement *node);
     void EmitConditionalGotoStatement(BoundConditionalGotoStatement *node);
+    void EmitCountedGotoStatement(BoundCountedGotoStatement *node);
     void EmitLabelStatement(BoundLabelStatement *node);
     void EmitReturnStatement(BoundReturnStatement *node);
 
@@ -2,9 +2,10 @@
 #define UTILS_H
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/Binder.h"
+#include "CodeAnalysis/Value.h"
 #include <unordered_map>
 
 void PrintDiagnostic(Diagnostic diagnostic, SourceText Text);
-void PrintVariables(const std::unordered_map<VariableSymbol, std::any> &variables);
+void PrintVariables(const std::unordered_map<VariableSymbol, Value> &variables);
 bool LookUpKeyword(std::string name);
 #endif
\ No newline at end of file
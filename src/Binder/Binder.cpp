@@ -39,7 +39,7 @@ BoundStatement *Binder::BindStatement(StatementSyntax *node)
 
 BoundStatement *Binder::BindErrorStatement()
 {
-    return new BoundExpressionStatement(new BoundErrorExpression());
+    return _arena->New<BoundExpressionStatement>(_arena->New<BoundErrorExpression>());
 }
 
 BoundStatement *Binder::BindIfStatement(IfStatementSyntax *node)
@@ -49,7 +49,7 @@ BoundStatement *Binder::BindIfStatement(IfStatementSyntax *node)
 
     BoundStatement *thenStatement = BindStatement(node->ThenStatement);
     BoundStatement *elseStatement = node->ElseClause == nullptr ? nullptr : BindStatement(node->ElseClause->ElseStatement);
-    return new BoundIfStatement(condition, thenStatement, elseStatement);
+    return _arena->New<BoundIfStatement>(condition, thenStatement, elseStatement);
 }
 
 BoundStatement *Binder::BindWhileStatement(WhileStatementSyntax *node)
@@ -61,14 +61,14 @@ BoundStatement *Binder::BindWhileStatement(WhileStatementSyntax *node)
 
     BoundStatement *body = BindLoopBody(node->Body, breakLabel, continueLabel);
 
-    return new BoundWhileStatement(condition, body, breakLabel, continueLabel);
+    return _arena->New<BoundWhileStatement>(condition, body, breakLabel, continueLabel);
 }
 
 BoundStatement *Binder::BindForStatement(ForStatementSyntax *node)
 {
     BoundExpression *lowerBound = BindExpression(node->LowerBound, TypeSymbol::Integer);
     BoundExpression *upperBound = BindExpression(node->UpperBound, TypeSymbol::Integer);
-    _scope = new BoundScope(_scope);
+    _scope = _scopes.New<BoundScope>(_scope);
     VariableSymbol *variable = BindVariableDeclaration(node->Identifier, false, TypeSymbol::Integer);
 
     BoundLabel *breakLabel = nullptr;
@@ -76,15 +76,15 @@ BoundStatement *Binder::BindForStatement(ForStatementSyntax *node)
     BoundStatement *body = BindLoopBody(node->Body, breakLabel, continueLabel);
 
     _scope = _scope->Parent;
-    return new BoundForStatement(*variable, lowerBound, upperBound, body, breakLabel, continueLabel);
+    return _arena->New<BoundForStatement>(*variable, lowerBound, upperBound, body, breakLabel, continueLabel);
 }
 
 BoundStatement *Binder::BindLoopBody(StatementSyntax *body, BoundLabel *&breakLabel, BoundLabel *&continueLabel)
 {
     _labelCounter++;
 
-    breakLabel = new BoundLabel("break" + std::to_string(_labelCounter));
-    continueLabel = new BoundLabel("continue" + std::to_string(_labelCounter));
+    breakLabel = _arena->New<BoundLabel>("break" + std::to_string(_labelCounter));
+    continueLabel = _arena->New<BoundLabel>("continue" + std::to_string(_labelCounter));
 
     _loopStack.push(std::make_pair(*breakLabel, *continueLabel));
     BoundStatement *boundBody = BindStatement(body);
@@ -97,20 +97,20 @@ BoundStatement *Binder::BindBreakStatement(BreakStatementSyntax *node)
 {
     if (_loopStack.empty())
     {
-        _diagnostics.ReportInvalidBreakOrContinue(node->Keyword.Location, node->Keyword.value);
+        _diagnostics.ReportInvalidBreakOrContinue(node->Keyword.GetLocation(), std::string(node->Keyword.Text()));
         return BindErrorStatement();
     }
-    return new BoundGotoStatement(_loopStack.top().first);
+    return _arena->New<BoundGotoStatement>(_loopStack.top().first);
 }
 
 BoundStatement *Binder::BindContinueStatement(ContinueStatementSyntax *node)
 {
     if (_loopStack.empty())
     {
-        _diagnostics.ReportInvalidBreakOrContinue(node->Keyword.Location, node->Keyword.value);
+        _diagnostics.ReportInvalidBreakOrContinue(node->Keyword.GetLocation(), std::string(node->Keyword.Text()));
         return BindErrorStatement();
     }
-    return new BoundGotoStatement(_loopStack.top().second);
+    return _arena->New<BoundGotoStatement>(_loopStack.top().second);
 }
 
 BoundStatement *Binder::BindReturnStatement(ReturnStatementSyntax *node)
@@ -118,7 +118,7 @@ BoundStatement *Binder::BindReturnStatement(ReturnStatementSyntax *node)
     BoundExpression *expression = node->Expression == nullptr ? nullptr : BindExpression(node->Expression);
     if (_function == nullptr)
     {
-        _diagnostics.ReportInvalidReturn(node->Keyword.Location);
+        _diagnostics.ReportInvalidReturn(node->Keyword.GetLocation());
     }
     else
     {
@@ -126,27 +126,27 @@ BoundStatement *Binder::BindReturnStatement(ReturnStatementSyntax *node)
         {
             if (expression != nullptr)
             {
-                _diagnostics.ReportInvalidReturnExpression(node->Keyword.Location, _function->Name);
+                _diagnostics.ReportInvalidReturnExpression(node->Keyword.GetLocation(), _function->Name);
             }
         }
         else
         {
             if (expression == nullptr)
             {
-                _diagnostics.ReportMissingReturnExpression(node->Keyword.Location, _function->Type.ToString());
+                _diagnostics.ReportMissingReturnExpression(node->Keyword.GetLocation(), _function->Type.ToString());
             }
             else
             {
-                expression = BindConversion(node->Expression->Location, expression, _function->Type);
+                expression = BindConversion(node->Expression, expression, _function->Type);
             }
         }
     }
-    return new BoundReturnStatement(expression);
+    return _arena->New<BoundReturnStatement>(expression);
 }
 
 BoundStatement *Binder::BindBlockStatement(BlockStatementSyntax *node)
 {
-    _scope = new BoundScope(_scope);
+    _scope = _scopes.New<BoundScope>(_scope);
     std::vector<BoundStatement *> statements;
 
     for (auto &statement : node->Statements)
@@ -154,7 +154,8 @@ BoundStatement *Binder::BindBlockStatement(BlockStatementSyntax *node)
         BoundStatement *boundStatement = BindStatement(statement);
         statements.push_back(boundStatement);
     }
-    return new BoundBlockStatement(statements);
+    _scope = _scope->Parent;
+    return _arena->New<BoundBlockStatement>(statements);
 }
 
 BoundExpression *Binder::BindLiteralExpression(LiteralExpressionNode *node)
@@ -164,54 +165,46 @@ BoundExpression *Binder::BindLiteralExpression(LiteralExpressionNode *node)
     {
     case SyntaxKind::TRUE_KEYWORD:
     case SyntaxKind::FALSE_KEYWORD:
-        return new BoundLiteralExpression(node->LiteralToken.value, TypeSymbol::Boolean);
+        return _arena->New<BoundLiteralExpression>(std::string(node->LiteralToken.Text()), TypeSymbol::Boolean);
     case SyntaxKind::NUMBER:
-        return new BoundLiteralExpression(node->LiteralToken.value, TypeSymbol::Integer);
+        return _arena->New<BoundLiteralExpression>(std::string(node->LiteralToken.Text()), TypeSymbol::Integer);
     case SyntaxKind::DECIMAL:
-        return new BoundLiteralExpression(node->LiteralToken.value, TypeSymbol::Float);
+        return _arena->New<BoundLiteralExpression>(std::string(node->LiteralToken.Text()), TypeSymbol::Float);
     case SyntaxKind::STRING:
-        return new BoundLiteralExpression(node->LiteralToken.value, TypeSymbol::String);
+        return _arena->New<BoundLiteralExpression>(std::string(node->LiteralToken.Text()), TypeSymbol::String);
     default:
-        _diagnostics.ReportUnexpectedToken(node->LiteralToken.Location, convertSyntaxKindToString(node->LiteralToken.Kind), "Literal Expression");
-        return new BoundErrorExpression();
+        _diagnostics.ReportUnexpectedToken(node->LiteralToken.GetLocation(), convertSyntaxKindToString(node->LiteralToken.Kind), "Literal Expression");
+        return _arena->New<BoundErrorExpression>();
     }
 }
 BoundExpression *Binder::BindNameExpression(NameExpressionNode *node)
 {
-    std::string name = node->IdentifierToken.value;
+    std::string name(node->IdentifierToken.Text());
     if (name.empty())
     {
 
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
     }
     VariableSymbol variable(name, false, TypeSymbol::Error);
     if (!_scope->TryLookupVariable(name, variable))
     {
         if (LookUpKeyword(name))
         {
-            _diagnostics.ReportUndefinedNameKeyword(node->IdentifierToken.Location, name);
+            _diagnostics.ReportUndefinedNameKeyword(node->IdentifierToken.GetLocation(), name);
         }
         else
         {
-            _diagnostics.ReportUndefinedName(node->IdentifierToken.Location, name);
+            _diagnostics.ReportUndefinedName(node->IdentifierToken.GetLocation(), name);
         }
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
     }
-    return new BoundVariableExpression(variable);
+    return _arena->New<BoundVariableExpression>(variable);
 }
 
 TypeSymbol Binder::GetArrayType(TypeSymbol arrayType)
 {
-    if (arrayType == TypeSymbol::ArrayInt)
-        return TypeSymbol::Integer;
-    if (arrayType == TypeSymbol::ArrayFloat)
-        return TypeSymbol::Float;
-    if (arrayType == TypeSymbol::ArrayString)
-        return TypeSymbol::String;
-    if (arrayType == TypeSymbol::ArrayBool)
-        return TypeSymbol::Boolean;
-    if (arrayType == TypeSymbol::ArrayAny)
-        return TypeSymbol::Any;
+    if (arrayType.IsArray())
+        return arrayType.ElementType();
     else
         return TypeSymbol::Error;
 }
@@ -222,8 +215,8 @@ BoundExpression *Binder::BindArrayAccessExpression(ArrayAccessExpressionSyntax *
 
     if (!variable->type.IsArray() && variable->type != TypeSymbol::String)
     {
-        _diagnostics.ReportInvalidArrayAccess(node->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportInvalidArrayAccess(node->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
     BoundExpression *indexExpression = BindExpression(node->Index);
 
@@ -232,25 +225,25 @@ BoundExpression *Binder::BindArrayAccessExpression(ArrayAccessExpressionSyntax *
 
     if (indexExpression->type != TypeSymbol::Integer)
     {
-        _diagnostics.ReportInvalidArrayIndex(node->Index->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportInvalidArrayIndex(node->Index->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
 
-    return new BoundArrayAccessExpression(variable, indexExpression);
+    return _arena->New<BoundArrayAccessExpression>(variable, indexExpression);
 }
 
 BoundExpression *Binder::GetDefaultValueExpression(TypeSymbol type, int arrSize)
 {
     if (type == TypeSymbol::Integer)
-        return new BoundLiteralExpression("0", TypeSymbol::Integer);
+        return _arena->New<BoundLiteralExpression>("0", TypeSymbol::Integer);
     if (type == TypeSymbol::Float)
-        return new BoundLiteralExpression("0.0", TypeSymbol::Float);
+        return _arena->New<BoundLiteralExpression>("0.0", TypeSymbol::Float);
     if (type == TypeSymbol::String)
-        return new BoundLiteralExpression("", TypeSymbol::String);
+        return _arena->New<BoundLiteralExpression>("", TypeSymbol::String);
     if (type == TypeSymbol::Boolean)
-        return new BoundLiteralExpression("false", TypeSymbol::Boolean);
+        return _arena->New<BoundLiteralExpression>("false", TypeSymbol::Boolean);
     if (type == TypeSymbol::Any)
-        return new BoundLiteralExpression("0", TypeSymbol::Any);
+        return _arena->New<BoundLiteralExpression>("0", TypeSymbol::Any);
     if (type.IsArray())
     {
         std::vector<BoundExpression *> elements;
@@ -258,10 +251,10 @@ BoundExpression *Binder::GetDefaultValueExpression(TypeSymbol type, int arrSize)
         {
             elements.push_back(GetDefaultValueExpression(GetArrayType(type), arrSize));
         }
-        return new BoundArrayInitializerExpression(elements, type);
+        return _arena->New<BoundArrayInitializerExpression>(elements, type);
     }
     else
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
 }
 TypeSymbol Binder::GenerateArrayType(TypeSymbol type)
 {
@@ -289,7 +282,7 @@ BoundStatement *Binder::BindArrayDeclaration(VariableDeclarationSyntax *node)
 
     //         if (elementType == TypeSymbol::Null)
     //         {
-    //             _diagnostics.ReportUndefinedType(node->ElementType->IdentifierToken.Location, node->ElementType->IdentifierToken.value);
+    //             _diagnostics.ReportUndefinedType(node->ElementType->IdentifierToken.GetLocation(), node->ElementType->IdentifierToken.value);
     //             return TypeSymbol::Error;
     //         }
 
@@ -320,16 +313,16 @@ BoundStatement *Binder::BindArrayDeclaration(VariableDeclarationSyntax *node)
                 BoundLiteralExpression *sizeLiteral = (BoundLiteralExpression *)size;
                 if (sizeLiteral->type != TypeSymbol::Integer)
                 {
-                    _diagnostics.ReportInvalidArraySize(node->Location);
-                    initializer = new BoundErrorExpression();
+                    _diagnostics.ReportInvalidArraySize(node->GetLocation());
+                    initializer = _arena->New<BoundErrorExpression>();
                 }
                 else
                 {
                     BoundArrayInitializerExpression *arrayInitializer = (BoundArrayInitializerExpression *)initializer;
                     if (arrayInitializer->Elements.size() != std::stoll(sizeLiteral->Value))
                     {
-                        _diagnostics.ReportArraySizeMismatch(node->Location, arrayInitializer->Elements.size(), std::stoll(sizeLiteral->Value));
-                        initializer = new BoundErrorExpression();
+                        _diagnostics.ReportArraySizeMismatch(node->GetLocation(), arrayInitializer->Elements.size(), std::stoll(sizeLiteral->Value));
+                        initializer = _arena->New<BoundErrorExpression>();
                     }
                 }
             }
@@ -346,8 +339,8 @@ BoundStatement *Binder::BindArrayDeclaration(VariableDeclarationSyntax *node)
             BoundLiteralExpression *sizeLiteral = (BoundLiteralExpression *)size;
             if (sizeLiteral->type != TypeSymbol::Integer)
             {
-                _diagnostics.ReportInvalidArraySize(node->Location);
-                initializer = new BoundErrorExpression();
+                _diagnostics.ReportInvalidArraySize(node->GetLocation());
+                initializer = _arena->New<BoundErrorExpression>();
             }
             else
             {
@@ -356,7 +349,7 @@ BoundStatement *Binder::BindArrayDeclaration(VariableDeclarationSyntax *node)
         }
         else
         {
-            _diagnostics.ReportArraySizeNotSpecified(node->Identifier.Location);
+            _diagnostics.ReportArraySizeNotSpecified(node->Identifier.GetLocation());
         }
     }
 
@@ -368,16 +361,16 @@ BoundStatement *Binder::BindArrayDeclaration(VariableDeclarationSyntax *node)
 
     if (node->Initializer == nullptr)
     {
-        convertedInitializer = BindConversion(node->TypeClause ? node->TypeClause->Location : node->Identifier.Location, initializer, variableType);
+        convertedInitializer = BindConversion(node->TypeClause ? static_cast<SyntaxNode *>(node->TypeClause) : &node->Identifier, initializer, variableType);
     }
     else
     {
-        convertedInitializer = BindConversion(node->Initializer->Location, initializer, variableType);
+        convertedInitializer = BindConversion(node->Initializer, initializer, variableType);
     }
 
     variable->Size = size != nullptr ? std::stoll(((BoundLiteralExpression *)size)->Value) : -1;
 
-    return new BoundVariableDeclaration(*variable, convertedInitializer);
+    return _arena->New<BoundVariableDeclaration>(*variable, convertedInitializer);
 }
 BoundStatement *Binder::BindVariableDeclaration(VariableDeclarationSyntax *node)
 {
@@ -401,25 +394,26 @@ BoundStatement *Binder::BindVariableDeclaration(VariableDeclarationSyntax *node)
 
     if (node->Initializer == nullptr)
     {
-        convertedInitializer = BindConversion(node->TypeClause ? node->TypeClause->Location : node->Identifier.Location, initializer, variableType);
+        convertedInitializer = BindConversion(node->TypeClause ? static_cast<SyntaxNode *>(node->TypeClause) : &node->Identifier, initializer, variableType);
     }
     else
     {
-        convertedInitializer = BindConversion(node->Initializer->Location, initializer, variableType);
+        convertedInitializer = BindConversion(node->Initializer, initializer, variableType);
     }
-    return new BoundVariableDeclaration(*variable, convertedInitializer);
+    return _arena->New<BoundVariableDeclaration>(*variable, convertedInitializer);
 }
 VariableSymbol *Binder::BindVariableDeclaration(Token identifier, bool isReadOnly, TypeSymbol type)
 {
-    std::string name = identifier.value;
+    std::string name(identifier.Text());
     bool declare = name != "" || !name.empty();
     VariableSymbol *variable = _function == nullptr
-                                   ? static_cast<VariableSymbol *>(new GlobalVariableSymbol(name, isReadOnly, type))
-                                   : static_cast<VariableSymbol *>(new LocalVariableSymbol(name, isReadOnly, type));
+                                   ? static_cast<VariableSymbol *>(_arena->New<GlobalVariableSymbol>(name, isReadOnly, type))
+                                   : static_cast<VariableSymbol *>(_arena->New<LocalVariableSymbol>(name, isReadOnly, type));
+    variable->Slot = _function == nullptr ? _globalCount++ : _localCount++;
 
     if (declare && !_scope->TryDeclareVariable(*variable))
     {
-        _diagnostics.ReportSymbolAlreadyDeclared(identifier.Location, name);
+        _diagnostics.ReportSymbolAlreadyDeclared(identifier.GetLocation(), name);
     }
 
     return variable;
@@ -434,27 +428,27 @@ BoundExpression *Binder::BindArrayInitializerExpression(ArrayInitializerSyntax *
 
         elements.push_back(boundExpression);
     }
-    return new BoundArrayInitializerExpression(elements, GenerateArrayType(type));
+    return _arena->New<BoundArrayInitializerExpression>(elements, GenerateArrayType(type));
 }
 
 BoundExpression *Binder::BindAssignmentExpression(AssignmentExpressionNode *node)
 {
-    std::string name = node->IdentifierToken.value;
+    std::string name(node->IdentifierToken.Text());
     BoundExpression *boundExpression = BindExpression(node->Expression);
     VariableSymbol variable(name, false, TypeSymbol::Error);
     if (!_scope->TryLookupVariable(name, variable))
     {
-        _diagnostics.ReportUndefinedName(node->IdentifierToken.Location, name);
+        _diagnostics.ReportUndefinedName(node->IdentifierToken.GetLocation(), name);
         return boundExpression;
     }
     if (variable.IsReadOnly)
     {
-        _diagnostics.ReportCannotAssign(node->IdentifierToken.Location, name);
+        _diagnostics.ReportCannotAssign(node->IdentifierToken.GetLocation(), name);
     }
 
-    BoundExpression *convertedExpression = BindConversion(node->Expression->Location, boundExpression, variable.Type);
+    BoundExpression *convertedExpression = BindConversion(node->Expression, boundExpression, variable.Type);
 
-    return new BoundAssignmentExpression(variable, convertedExpression);
+    return _arena->New<BoundAssignmentExpression>(variable, convertedExpression);
 }
 
 BoundExpression *Binder::BindArrayAssignmentExpression(ArrayAssignmentExpressionSyntax *node)
@@ -463,8 +457,8 @@ BoundExpression *Binder::BindArrayAssignmentExpression(ArrayAssignmentExpression
 
     if (!identifier->type.IsArray() && identifier->type != TypeSymbol::String)
     {
-        _diagnostics.ReportInvalidArrayAccess(node->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportInvalidArrayAccess(node->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
     BoundExpression *indexExpression = BindExpression(node->Index);
     VariableSymbol variableSymbol = ((BoundVariableExpression *)identifier)->Variable;
@@ -473,23 +467,23 @@ BoundExpression *Binder::BindArrayAssignmentExpression(ArrayAssignmentExpression
 
     if (variableSymbol.IsReadOnly)
     {
-        _diagnostics.ReportCannotAssign(node->Identifier->Location, variableSymbol.Name);
+        _diagnostics.ReportCannotAssign(node->Identifier->GetLocation(), variableSymbol.Name);
     }
     if (indexExpression->type != TypeSymbol::Integer)
     {
-        _diagnostics.ReportInvalidArrayIndex(node->Index->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportInvalidArrayIndex(node->Index->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
 
     BoundExpression *boundExpression = BindExpression(node->Expression);
 
     if (boundExpression->type != elementsType)
     {
-        _diagnostics.ReportTypeMismatch(node->Expression->Location, elementsType.ToString(), boundExpression->type.ToString());
-        return new BoundErrorExpression();
+        _diagnostics.ReportTypeMismatch(node->Expression->GetLocation(), elementsType.ToString(), boundExpression->type.ToString());
+        return _arena->New<BoundErrorExpression>();
     }
 
-    return new BoundArrayAssignmentExpression(identifier, indexExpression, boundExpression, variableSymbol);
+    return _arena->New<BoundArrayAssignmentExpression>(identifier, indexExpression, boundExpression, variableSymbol);
 }
 
 BoundExpression *Binder::BindUnaryExpression(UnaryExpressionNode *node)
@@ -498,15 +492,15 @@ BoundExpression *Binder::BindUnaryExpression(UnaryExpressionNode *node)
 
     if (boundOperand->type == TypeSymbol::Error)
     {
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
     }
-    BoundUnaryOperator *boundOperator = BoundUnaryOperator::Bind(node->OperatorToken.Kind, boundOperand->type);
+    const BoundUnaryOperator *boundOperator = BoundUnaryOperator::Bind(node->OperatorToken.Kind, boundOperand->type);
     if (boundOperator == nullptr)
     {
-        _diagnostics.ReportUndefinedUnaryOperator(node->OperatorToken.Location, node->OperatorToken.value, boundOperand->type.ToString());
-        return new BoundErrorExpression();
+        _diagnostics.ReportUndefinedUnaryOperator(node->OperatorToken.GetLocation(), std::string(node->OperatorToken.Text()), boundOperand->type.ToString());
+        return _arena->New<BoundErrorExpression>();
     }
-    return new BoundUnaryExpression(boundOperator, boundOperand);
+    return _arena->New<BoundUnaryExpression>(boundOperator, boundOperand);
 }
 
 BoundExpression *Binder::BindBinaryExpression(BinaryExpressionNode *node)
@@ -516,25 +510,25 @@ BoundExpression *Binder::BindBinaryExpression(BinaryExpressionNode *node)
 
     if (boundLeft->type == TypeSymbol::Error || boundRight->type == TypeSymbol::Error)
     {
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
     }
-    BoundBinaryOperator *boundOperator = BoundBinaryOperator::Bind(node->OperatorToken.Kind, boundLeft->type, boundRight->type);
+    const BoundBinaryOperator *boundOperator = BoundBinaryOperator::Bind(node->OperatorToken.Kind, boundLeft->type, boundRight->type);
 
     if (boundOperator == nullptr)
     {
 
-        _diagnostics.ReportUndefinedBinaryOperator(node->OperatorToken.Location, node->OperatorToken.value, boundLeft->type.ToString(), boundRight->type.ToString());
-        return new BoundErrorExpression();
+        _diagnostics.ReportUndefinedBinaryOperator(node->OperatorToken.GetLocation(), std::string(node->OperatorToken.Text()), boundLeft->type.ToString(), boundRight->type.ToString());
+        return _arena->New<BoundErrorExpression>();
     }
 
-    return new BoundBinaryExpression(boundLeft, boundOperator, boundRight);
+    return _arena->New<BoundBinaryExpression>(boundLeft, boundOperator, boundRight);
 }
 
 BoundExpression *Binder::BindCallExpression(CallExpressionNode *node)
 {
     if (node->Arguments.Count() == 1)
     {
-        TypeSymbol type = LookupType(node->IdentifierToken.value);
+        TypeSymbol type = LookupType(std::string(node->IdentifierToken.Text()));
         if (type != TypeSymbol::Null)
             return BindConversion(node->Arguments[0], type, true);
     }
@@ -547,10 +541,10 @@ BoundExpression *Binder::BindCallExpression(CallExpressionNode *node)
     }
 
     FunctionSymbol function;
-    if (!_scope->TryLookupFunction(node->IdentifierToken.value, function))
+    if (!_scope->TryLookupFunction(std::string(node->IdentifierToken.Text()), function))
     {
-        _diagnostics.ReportUndefinedFunction(node->IdentifierToken.Location, node->IdentifierToken.value);
-        return new BoundErrorExpression();
+        _diagnostics.ReportUndefinedFunction(node->IdentifierToken.GetLocation(), std::string(node->IdentifierToken.Text()));
+        return _arena->New<BoundErrorExpression>();
     }
 
     if (node->Arguments.Count() != function.Parameters.size())
@@ -576,36 +570,38 @@ BoundExpression *Binder::BindCallExpression(CallExpressionNode *node)
         }
         TextLocation location = TextLocation(node->syntaxTree->Text, Span);
         _diagnostics.ReportWrongArgumentCount(location, function.Name, function.Parameters.size(), node->Arguments.Count());
-        return new BoundErrorExpression();
+        return _arena->New<BoundErrorExpression>();
     }
 
     // bool hasErrors = false;
 
     for (int i = 0; i < node->Arguments.Count(); i++)
     {
-        TextLocation argumentLocation = node->Arguments[i]->Location;
         BoundExpression *argument = boundArguments[i];
         ParameterSymbol parameter = function.Parameters[i];
         // if (argument->type != parameter.Type)
         // {
         //     if (argument->type != TypeSymbol::Error)
         //     {
-        //         _diagnostics.ReportWrongArgumentType(node->Arguments[i]->Location, parameter.Name, parameter.Type.ToString(), argument->type.ToString());
+        //         _diagnostics.ReportWrongArgumentType(node->Arguments[i]->GetLocation(), parameter.Name, parameter.Type.ToString(), argument->type.ToString());
         //     }
 
         //     hasErrors = true;
         // }
-        boundArguments[i] = BindConversion(argumentLocation, argument, parameter.Type);
+        boundArguments[i] = BindConversion(node->Arguments[i], argument, parameter.Type);
     }
 
     // if (hasErrors)
-    //     return new BoundErrorExpression();
-    return new BoundCallExpression(function, boundArguments);
+    //     return _arena->New<BoundErrorExpression>();
+    return _arena->New<BoundCallExpression>(function, boundArguments);
 }
 BoundGlobalScope *Binder::BindGlobalScope(BoundGlobalScope *previous, std::vector<SyntaxTree *> syntaxTrees)
 {
-    BoundScope *parentScope = Binder::CreateParentScope(previous);
-    Binder binder(parentScope, nullptr);
+    BoundGlobalScope *result = new BoundGlobalScope(previous);
+    Arena scopes;
+    BoundScope *parentScope = Binder::CreateParentScope(&scopes, previous);
+    Binder binder(&result->Nodes, parentScope, nullptr);
+    binder._globalCount = previous == nullptr ? 0 : previous->GlobalCount;
 
     std::vector<FunctionDeclarationSyntax *> functionDeclarations;
     std::vector<GlobalStatementSyntax *> globalStatements;
@@ -632,31 +628,30 @@ BoundGlobalScope *Binder::BindGlobalScope(BoundGlobalScope *previous, std::vecto
         binder.BindFunctionDeclaration(functionDeclaration);
     }
 
-    std::vector<BoundStatement *> statements;
-
     for (const auto &globalStatement : globalStatements)
     {
         BoundStatement *statement = binder.BindStatement(globalStatement->Statement);
-        statements.push_back(statement);
+        result->Statements.push_back(statement);
     }
-    std::vector<FunctionSymbol> functions = binder._scope->GetDeclaredFunctions();
-    std::vector<VariableSymbol> variables = binder._scope->GetDeclaredVariables();
+    result->Functions = binder._scope->GetDeclaredFunctions();
+    result->Variables = binder._scope->GetDeclaredVariables();
 
-    std::vector<Diagnostic> diagnostics = binder.GetDiagnostics().GetDiagnostics();
+    result->Diagnostics = binder.GetDiagnostics().GetDiagnostics();
 
     if (previous != nullptr)
     {
-        diagnostics.insert(diagnostics.begin(), previous->Diagnostics.begin(), previous->Diagnostics.end());
+        result->Diagnostics.insert(result->Diagnostics.begin(), previous->Diagnostics.begin(), previous->Diagnostics.end());
     }
-    return new BoundGlobalScope(previous, diagnostics, variables, functions, statements);
+    result->GlobalCount = binder._globalCount;
+    return result;
 }
 
 BoundProgram *Binder::BindProgram(BoundGlobalScope *globalScope)
 {
-
-    BoundScope parentScope = CreateParentScope(globalScope);
-    std::unordered_map<FunctionSymbol, BoundBlockStatement *> functions = {};
-    std::vector<Diagnostic> diagnostics = {};
+    BoundProgram *program = new BoundProgram(GetGlobals(globalScope), globalScope->GlobalCount);
+    Arena *arena = &program->Nodes;
+    Arena scopes;
+    BoundScope *parentScope = CreateParentScope(&scopes, globalScope);
 
     BoundGlobalScope *scope = globalScope;
 
@@ -664,32 +659,39 @@ BoundProgram *Binder::BindProgram(BoundGlobalScope *globalScope)
     {
         for (auto &function : scope->Functions)
         {
-            Binder binder(&parentScope, &function);
+            Binder binder(arena, parentScope, &function);
             BoundStatement *body = binder.BindStatement(function.Declaration->Body);
-            BoundBlockStatement *loweredBody = Lowerer::Lower(body);
+            BoundBlockStatement *loweredBody = Lowerer::Lower(arena, body, binder._localCount);
 
             if (function.Type != TypeSymbol::Void && !ControlFlowGraph::AllPathsReturn(loweredBody))
             {
-                binder._diagnostics.ReportAllPathsMustReturn(function.Declaration->Identifier.Location);
+                binder._diagnostics.ReportAllPathsMustReturn(function.Declaration->Identifier.GetLocation());
             }
-            functions[function] = loweredBody;
+            program->Functions[function] = loweredBody;
 
-            diagnostics.insert(diagnostics.end(), binder.GetDiagnostics().GetDiagnostics().begin(), binder.GetDiagnostics().GetDiagnostics().end());
+            program->Diagnostics.insert(program->Diagnostics.end(), binder.GetDiagnostics().GetDiagnostics().begin(), binder.GetDiagnostics().GetDiagnostics().end());
         }
 
         scope = scope->Previous;
     }
 
-    BoundBlockStatement *statement = Lowerer::Lower(new BoundBlockStatement(globalScope->Statements));
-    return new BoundProgram(diagnostics, functions, statement);
+    program->statement = Lowerer::Lower(arena, arena->New<BoundBlockStatement>(globalScope->Statements));
+    Inliner::Inline(program);
+    PurityAnalyzer::Analyze(program);
+    for (auto &[function, body] : program->Functions)
+        body = CallLifter::Lift(arena, body);
+    program->statement = CallLifter::Lift(arena, program->statement);
+    ConstantPool::Build(program);
+    CallResolver::Resolve(program);
+    return program;
 }
 
 BoundProgram *Binder::BindEmitableProgram(BoundGlobalScope *globalScope)
 {
-
-    BoundScope parentScope = CreateParentScope(globalScope);
-    std::unordered_map<FunctionSymbol, BoundBlockStatement *> functions = {};
-    std::vector<Diagnostic> diagnostics = {};
+    BoundProgram *program = new BoundProgram(GetGlobals(globalScope), globalScope->GlobalCount);
+    Arena *arena = &program->Nodes;
+    Arena scopes;
+    BoundScope *parentScope = CreateParentScope(&scopes, globalScope);
 
     BoundGlobalScope *scope = globalScope;
 
@@ -697,25 +699,37 @@ BoundProgram *Binder::BindEmitableProgram(BoundGlobalScope *globalScope)
     {
         for (auto &function : scope->Functions)
         {
-            Binder binder(&parentScope, &function);
+            Binder binder(arena, parentScope, &function);
             BoundStatement *body = binder.BindStatement(function.Declaration->Body);
-            BoundBlockStatement *loweredBody = Lowerer::LowerEmitable(body);
-            BoundBlockStatement *flatBody = Lowerer::Flatten(loweredBody);
+            BoundBlockStatement *loweredBody = Lowerer::LowerEmitable(arena, body, binder._localCount);
+            BoundBlockStatement *flatBody = Lowerer::Flatten(arena, loweredBody);
             if (function.Type != TypeSymbol::Void && !ControlFlowGraph::AllPathsReturn(flatBody))
             {
-                binder._diagnostics.ReportAllPathsMustReturn(function.Declaration->Identifier.Location);
+                binder._diagnostics.ReportAllPathsMustReturn(function.Declaration->Identifier.GetLocation());
             }
-            functions[function] = loweredBody;
+            program->Functions[function] = loweredBody;
 
-            diagnostics.insert(diagnostics.end(), binder.GetDiagnostics().GetDiagnostics().begin(), binder.GetDiagnostics().GetDiagnostics().end());
+            program->Diagnostics.insert(program->Diagnostics.end(), binder.GetDiagnostics().GetDiagnostics().begin(), binder.GetDiagnostics().GetDiagnostics().end());
         }
 
         scope = scope->Previous;
     }
 
-    BoundBlockStatement *statement = Lowerer::Lower(new BoundBlockStatement(globalScope->Statements));
-    return new BoundProgram(diagnostics, functions, statement);
+    program->statement = Lowerer::Lower(arena, arena->New<BoundBlockStatement>(globalScope->Statements));
+    return program;
+}
+
+std::vector<VariableSymbol> Binder::GetGlobals(BoundGlobalScope *globalScope)
+{
+    std::vector<VariableSymbol> globals;
+    while (globalScope != nullptr)
+    {
+        globals.insert(globals.begin(), globalScope->Variables.begin(), globalScope->Variables.end());
+        globalScope = globalScope->Previous;
+    }
+    return globals;
 }
+
 void Binder::BindFunctionDeclaration(FunctionDeclarationSyntax *node)
 {
     std::vector<ParameterSymbol> parameters;
@@ -723,7 +737,7 @@ void Binder::BindFunctionDeclaration(FunctionDeclarationSyntax *node)
 
     for (const auto &parameter : node->Parameters)
     {
-        std::string parameterName = parameter->IdentifierToken.value;
+        std::string parameterName(parameter->IdentifierToken.Text());
         TypeSymbol boundType = BindTypeClause(parameter->Type);
 
         if (parameter->Type->IsArray)
@@ -735,37 +749,40 @@ void Binder::BindFunctionDeclaration(FunctionDeclarationSyntax *node)
 
         if (seenParameterNames.find(parameterName) != seenParameterNames.end())
         {
-            _diagnostics.ReportParameterAlreadyDeclared(parameter->IdentifierToken.Location, parameterName);
+            _diagnostics.ReportParameterAlreadyDeclared(parameter->IdentifierToken.GetLocation(), parameterName);
         }
         else
         {
             seenParameterNames.insert(parameterName);
-            parameters.push_back(ParameterSymbol(parameterName, parameterType));
+            ParameterSymbol parameterSymbol(parameterName, parameterType);
+            parameterSymbol.Slot = parameters.size();
+            parameters.push_back(parameterSymbol);
         }
     }
 
     TypeSymbol boundResultType = BindTypeClause(node->Type);
     TypeSymbol returnType = boundResultType != TypeSymbol::Null ? boundResultType : TypeSymbol::Void;
 
-    FunctionSymbol function(node->Identifier.value, parameters, returnType, node);
+    FunctionSymbol function(std::string(node->Identifier.Text()), parameters, returnType, node);
 
-    if (!function.Declaration->Identifier.value.empty() && !_scope->TryDeclareFunction(function))
+    if (!function.Declaration->Identifier.Text().empty() && !_scope->TryDeclareFunction(function))
     {
-        _diagnostics.ReportSymbolAlreadyDeclared(node->Identifier.Location, function.Name);
+        _diagnostics.ReportSymbolAlreadyDeclared(node->Identifier.GetLocation(), function.Name);
     }
 }
 
-BoundScope *Binder::CreateRootScope()
+BoundScope *Binder::CreateRootScope(Arena *arena)
 {
-    BoundScope *result = new BoundScope(nullptr);
-    for (auto &function : BuiltInFunctions::GetAll())
+    BoundScope *result = arena->New<BoundScope>(nullptr);
+    for (auto &builtIn : BuiltInFunctions::GetAll())
     {
+        FunctionSymbol function = builtIn.Function;
         result->TryDeclareFunction(function);
     }
 
     return result;
 }
-BoundScope *Binder::CreateParentScope(BoundGlobalScope *previous)
+BoundScope *Binder::CreateParentScope(Arena *arena, BoundGlobalScope *previous)
 {
     std::stack<BoundGlobalScope *> stack;
     while (previous != nullptr)
@@ -775,13 +792,13 @@ BoundScope *Binder::CreateParentScope(BoundGlobalScope *previous)
         previous = previous->Previous;
     }
 
-    BoundScope *parent = CreateRootScope();
+    BoundScope *parent = CreateRootScope(arena);
 
     while (!stack.empty())
     {
         previous = stack.top();
         stack.pop();
-        BoundScope *scope = new BoundScope(parent);
+        BoundScope *scope = arena->New<BoundScope>(parent);
 
         for (auto &function : previous->Functions)
         {
@@ -830,11 +847,11 @@ TypeSymbol Binder::BindTypeClause(TypeClauseNode *node)
         return TypeSymbol::Null;
     }
 
-    TypeSymbol type = LookupType(node->IdentifierToken.value);
+    TypeSymbol type = LookupType(std::string(node->IdentifierToken.Text()));
 
     if (type == TypeSymbol::Null)
     {
-        _diagnostics.ReportUndefinedType(node->IdentifierToken.Location, node->IdentifierToken.value);
+        _diagnostics.ReportUndefinedType(node->IdentifierToken.GetLocation(), std::string(node->IdentifierToken.Text()));
     }
     return type;
 }
@@ -842,7 +859,7 @@ TypeSymbol Binder::BindTypeClause(TypeClauseNode *node)
 BoundStatement *Binder::BindExpressionStatement(ExpressionStatementSyntax *node)
 {
     BoundExpression *expression = BindExpression(node->Expression, true);
-    return new BoundExpressionStatement(expression);
+    return _arena->New<BoundExpressionStatement>(expression);
 }
 
 BoundExpression *Binder::BindExpression(SyntaxNode *node, TypeSymbol type)
@@ -856,8 +873,8 @@ BoundExpression *Binder::BindExpression(SyntaxNode *node, bool canBeVoid)
 
     if (!canBeVoid && result->type == TypeSymbol::Void)
     {
-        _diagnostics.ReportExpressionMustHaveValue(node->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportExpressionMustHaveValue(node->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
     return result;
 }
@@ -886,8 +903,8 @@ BoundExpression *Binder::BindExpressionInternal(SyntaxNode *node)
         return BindArrayAssignmentExpression((ArrayAssignmentExpressionSyntax *)node);
     case SyntaxKind::ArrayInitializer:
     {
-        _diagnostics.ReportInvalidArrayInitializer(node->Location);
-        return new BoundErrorExpression();
+        _diagnostics.ReportInvalidArrayInitializer(node->GetLocation());
+        return _arena->New<BoundErrorExpression>();
     }
 
     default:
@@ -898,22 +915,22 @@ BoundExpression *Binder::BindExpressionInternal(SyntaxNode *node)
 BoundExpression *Binder::BindConversion(SyntaxNode *node, TypeSymbol type, bool allowExplicit)
 {
     BoundExpression *expression = BindExpression(node);
-    return BindConversion(node->Location, expression, type, allowExplicit);
+    return BindConversion(node, expression, type, allowExplicit);
 }
-BoundExpression *Binder::BindConversion(TextLocation diagnosticLocation, BoundExpression *expression, TypeSymbol type, bool allowExplicit)
+BoundExpression *Binder::BindConversion(const SyntaxNode *diagnosticNode, BoundExpression *expression, TypeSymbol type, bool allowExplicit)
 {
     Conversion conversion = Conversion::Classify(expression->type, type);
 
     if (!conversion.Exists)
     {
         if (expression->type != TypeSymbol::Error && type != TypeSymbol::Error)
-            _diagnostics.ReportCannotConvert(diagnosticLocation, expression->type.ToString(), type.ToString());
-        return new BoundErrorExpression();
+            _diagnostics.ReportCannotConvert(diagnosticNode->GetLocation(), expression->type.ToString(), type.ToString());
+        return _arena->New<BoundErrorExpression>();
     }
 
     if (!allowExplicit && conversion.IsExplicit)
     {
-        _diagnostics.ReportCannotConvertImplicitly(diagnosticLocation, expression->type.ToString(), type.ToString());
+        _diagnostics.ReportCannotConvertImplicitly(diagnosticNode->GetLocation(), expression->type.ToString(), type.ToString());
     }
 
     if (conversion.IsIdentity)
@@ -921,7 +938,7 @@ BoundExpression *Binder::BindConversion(TextLocation diagnosticLocation, BoundEx
         return expression;
     }
 
-    return new BoundConversionExpression(type, expression);
+    return _arena->New<BoundConversionExpression>(type, expression);
 }
 // enum class BoundNodeKind
 // {
@@ -978,6 +995,8 @@ std::string convertBoundNodeKindToString(BoundNodeKind kind)
         return "LabelStatement";
     case BoundNodeKind::ConditionalGotoStatement:
         return "ConditionalGotoStatement";
+    case BoundNodeKind::CountedGotoStatement:
+        return "CountedGotoStatement";
     case BoundNodeKind::CallExpression:
         return "CallExpression";
     case BoundNodeKind::ConversionExpression:
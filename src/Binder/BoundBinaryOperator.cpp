@@ -1,74 +1,99 @@
 #include "CodeAnalysis/Binder.h"
 #include "CodeAnalysis/SyntaxTree.h"
+#include <functional>
 #include <iostream>
+#include <stdexcept>
 
-BoundBinaryOperator *BoundBinaryOperator::Bind(SyntaxKind syntaxKind, TypeSymbol leftType, TypeSymbol rightType)
+template <typename Operation, typename Operand, Operand (Value::*Read)() const>
+static Value Apply(const Value &left, const Value &right)
 {
+    return Value(Operation()((left.*Read)(), (right.*Read)()));
+}
+
+// Float operators read through AsNumber, which also covers the mixed
+// int/float overloads.
+template <template <typename> class Operation>
+constexpr BinaryOperatorHandler IntegerHandler = &Apply<Operation<long long>, long long, &Value::AsInteger>;
+template <template <typename> class Operation>
+constexpr BinaryOperatorHandler FloatHandler = &Apply<Operation<double>, double, &Value::AsNumber>;
+template <template <typename> class Operation>
+constexpr BinaryOperatorHandler BooleanHandler = &Apply<Operation<bool>, bool, &Value::AsBoolean>;
+template <template <typename> class Operation>
+constexpr BinaryOperatorHandler StringHandler = &Apply<Operation<std::string>, const std::string &, &Value::AsString>;
+
+static Value DivideIntegers(const Value &left, const Value &right)
+{
+    if (right.AsInteger() == 0)
+        throw std::runtime_error("Division by zero");
+    return Value(left.AsInteger() / right.AsInteger());
+}
 
-    for (auto op : operators)
+const BoundBinaryOperator *BoundBinaryOperator::Bind(SyntaxKind syntaxKind, TypeSymbol leftType, TypeSymbol rightType)
+{
+
+    for (const auto &op : operators)
     {
         if (op.syntaxKind == syntaxKind && op.LeftType == leftType && op.RightType == rightType)
         {
-
-            return new BoundBinaryOperator(op.syntaxKind, op.Kind, op.LeftType, op.RightType, op.ResultType);
+            return &op;
         }
     }
     return nullptr;
 }
 
 const std::vector<BoundBinaryOperator> BoundBinaryOperator::operators{
-    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Integer),
-    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Integer),
-    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Integer),
-    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Integer),
-
-    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Float),
-
-    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float),
-
-    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float),
-    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float),
-
-    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::String),
-    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::String, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::String, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::AMPERSAND, BoundBinaryOperatorKind::BitwiseAnd, TypeSymbol::Integer),
-    BoundBinaryOperator(SyntaxKind::PIPE, BoundBinaryOperatorKind::BitwiseOr, TypeSymbol::Integer),
-    BoundBinaryOperator(SyntaxKind::HAT, BoundBinaryOperatorKind::BitwiseXor, TypeSymbol::Integer),
-
-    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Integer, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Integer, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Float, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Float, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::LESS, BoundBinaryOperatorKind::Less, TypeSymbol::Integer, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::LESS_EQUALS, BoundBinaryOperatorKind::LessOrEquals, TypeSymbol::Integer, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::GREATER, BoundBinaryOperatorKind::Greater, TypeSymbol::Integer, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::GREATER_EQUALS, BoundBinaryOperatorKind::GreaterOrEquals, TypeSymbol::Integer, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::LESS, BoundBinaryOperatorKind::Less, TypeSymbol::Float, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::LESS_EQUALS, BoundBinaryOperatorKind::LessOrEquals, TypeSymbol::Float, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::GREATER, BoundBinaryOperatorKind::Greater, TypeSymbol::Float, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::GREATER_EQUALS, BoundBinaryOperatorKind::GreaterOrEquals, TypeSymbol::Float, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::AMPERSAND, BoundBinaryOperatorKind::BitwiseAnd, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::PIPE, BoundBinaryOperatorKind::BitwiseOr, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::HAT, BoundBinaryOperatorKind::BitwiseXor, TypeSymbol::Boolean),
-
-    BoundBinaryOperator(SyntaxKind::AMPERSAND_AMPERSAND, BoundBinaryOperatorKind::LogicalAnd, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::PIPE_PIPE, BoundBinaryOperatorKind::LogicalOr, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Boolean),
-    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Boolean),
+    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Integer, IntegerHandler<std::plus>),
+    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Integer, IntegerHandler<std::minus>),
+    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Integer, IntegerHandler<std::multiplies>),
+    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Integer, &DivideIntegers),
+
+    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Float, FloatHandler<std::plus>),
+    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Float, FloatHandler<std::minus>),
+    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Float, FloatHandler<std::multiplies>),
+    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Float, FloatHandler<std::divides>),
+
+    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float, FloatHandler<std::plus>),
+    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float, FloatHandler<std::minus>),
+    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float, FloatHandler<std::multiplies>),
+    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Float, TypeSymbol::Integer, TypeSymbol::Float, FloatHandler<std::divides>),
+
+    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float, FloatHandler<std::plus>),
+    BoundBinaryOperator(SyntaxKind::MINUS, BoundBinaryOperatorKind::Subtraction, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float, FloatHandler<std::minus>),
+    BoundBinaryOperator(SyntaxKind::MULTIPLY, BoundBinaryOperatorKind::Multiplication, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float, FloatHandler<std::multiplies>),
+    BoundBinaryOperator(SyntaxKind::DIVIDE, BoundBinaryOperatorKind::Division, TypeSymbol::Integer, TypeSymbol::Float, TypeSymbol::Float, FloatHandler<std::divides>),
+
+    BoundBinaryOperator(SyntaxKind::PLUS, BoundBinaryOperatorKind::Addition, TypeSymbol::String, StringHandler<std::plus>),
+    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::String, TypeSymbol::Boolean, StringHandler<std::equal_to>),
+    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::String, TypeSymbol::Boolean, StringHandler<std::not_equal_to>),
+
+    BoundBinaryOperator(SyntaxKind::AMPERSAND, BoundBinaryOperatorKind::BitwiseAnd, TypeSymbol::Integer, IntegerHandler<std::bit_and>),
+    BoundBinaryOperator(SyntaxKind::PIPE, BoundBinaryOperatorKind::BitwiseOr, TypeSymbol::Integer, IntegerHandler<std::bit_or>),
+    BoundBinaryOperator(SyntaxKind::HAT, BoundBinaryOperatorKind::BitwiseXor, TypeSymbol::Integer, IntegerHandler<std::bit_xor>),
+
+    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::equal_to>),
+    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::not_equal_to>),
+
+    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::equal_to>),
+    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::not_equal_to>),
+
+    BoundBinaryOperator(SyntaxKind::LESS, BoundBinaryOperatorKind::Less, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::less>),
+    BoundBinaryOperator(SyntaxKind::LESS_EQUALS, BoundBinaryOperatorKind::LessOrEquals, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::less_equal>),
+    BoundBinaryOperator(SyntaxKind::GREATER, BoundBinaryOperatorKind::Greater, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::greater>),
+    BoundBinaryOperator(SyntaxKind::GREATER_EQUALS, BoundBinaryOperatorKind::GreaterOrEquals, TypeSymbol::Integer, TypeSymbol::Boolean, IntegerHandler<std::greater_equal>),
+
+    BoundBinaryOperator(SyntaxKind::LESS, BoundBinaryOperatorKind::Less, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::less>),
+    BoundBinaryOperator(SyntaxKind::LESS_EQUALS, BoundBinaryOperatorKind::LessOrEquals, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::less_equal>),
+    BoundBinaryOperator(SyntaxKind::GREATER, BoundBinaryOperatorKind::Greater, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::greater>),
+    BoundBinaryOperator(SyntaxKind::GREATER_EQUALS, BoundBinaryOperatorKind::GreaterOrEquals, TypeSymbol::Float, TypeSymbol::Boolean, FloatHandler<std::greater_equal>),
+
+    BoundBinaryOperator(SyntaxKind::AMPERSAND, BoundBinaryOperatorKind::BitwiseAnd, TypeSymbol::Boolean, BooleanHandler<std::bit_and>),
+    BoundBinaryOperator(SyntaxKind::PIPE, BoundBinaryOperatorKind::BitwiseOr, TypeSymbol::Boolean, BooleanHandler<std::bit_or>),
+    BoundBinaryOperator(SyntaxKind::HAT, BoundBinaryOperatorKind::BitwiseXor, TypeSymbol::Boolean, BooleanHandler<std::bit_xor>),
+
+    BoundBinaryOperator(SyntaxKind::AMPERSAND_AMPERSAND, BoundBinaryOperatorKind::LogicalAnd, TypeSymbol::Boolean, BooleanHandler<std::logical_and>),
+    BoundBinaryOperator(SyntaxKind::PIPE_PIPE, BoundBinaryOperatorKind::LogicalOr, TypeSymbol::Boolean, BooleanHandler<std::logical_or>),
+    BoundBinaryOperator(SyntaxKind::EQUALS_EQUALS, BoundBinaryOperatorKind::Equals, TypeSymbol::Boolean, BooleanHandler<std::equal_to>),
+    BoundBinaryOperator(SyntaxKind::BANG_EQUALS, BoundBinaryOperatorKind::NotEquals, TypeSymbol::Boolean, BooleanHandler<std::not_equal_to>),
 
 };
 
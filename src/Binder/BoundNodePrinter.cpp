@@ -41,6 +41,9 @@ void BoundNodePrinter::WriteTo(const BoundNode *node, IndentedTextWriter &writer
     case BoundNodeKind::ConditionalGotoStatement:
         WriteConditionalGotoStatement((BoundConditionalGotoStatement *)node, writer);
         break;
+    case BoundNodeKind::CountedGotoStatement:
+        WriteCountedGotoStatement((BoundCountedGotoStatement *)node, writer);
+        break;
     case BoundNodeKind::ReturnStatement:
         WriteReturnStatement((BoundReturnStatement *)node, writer);
         break;
@@ -246,6 +249,21 @@ void BoundNodePrinter::WriteConditionalGotoStatement(const BoundConditionalGotoS
     writer.WriteLine();
 }
 
+void BoundNodePrinter::WriteCountedGotoStatement(const BoundCountedGotoStatement *node, IndentedTextWriter &writer)
+{
+    writer.WriteKeyword("goto");
+    writer.Write(" ");
+    writer.WriteIdentifier(node->Label.ToString());
+    writer.Write(" while ");
+    writer.Write(" (");
+    writer.WritePunctuation("++");
+    node->Variable->WriteTo(writer);
+    writer.WritePunctuation(" <= ");
+    node->UpperBound->WriteTo(writer);
+    writer.WritePunctuation(")");
+    writer.WriteLine();
+}
+
 void BoundNodePrinter::WriteExpressionStatement(const BoundExpressionStatement *node, IndentedTextWriter &writer)
 {
     node->Expression->WriteTo(writer);
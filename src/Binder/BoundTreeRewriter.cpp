@@ -22,6 +22,8 @@ BoundStatement *BoundTreeRewriter::RewriteStatement(BoundStatement *node)
         return RewriteLabelStatement((BoundLabelStatement *)node);
     case BoundNodeKind::ConditionalGotoStatement:
         return RewriteConditionalGotoStatement((BoundConditionalGotoStatement *)node);
+    case BoundNodeKind::CountedGotoStatement:
+        return RewriteCountedGotoStatement((BoundCountedGotoStatement *)node);
     case BoundNodeKind::ReturnStatement:
         return RewriteReturnStatement((BoundReturnStatement *)node);
     default:
@@ -45,7 +47,7 @@ BoundStatement *BoundTreeRewriter::RewriteBlockStatement(BoundBlockStatement *no
     if (!hasChanges)
         return node;
 
-    return new BoundBlockStatement(newStatements);
+    return _arena->New<BoundBlockStatement>(newStatements);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteVariableDeclaration(BoundVariableDeclaration *node)
@@ -54,7 +56,7 @@ BoundStatement *BoundTreeRewriter::RewriteVariableDeclaration(BoundVariableDecla
     if (initializer == node->Initializer)
         return node;
 
-    return new BoundVariableDeclaration(node->Variable, initializer);
+    return _arena->New<BoundVariableDeclaration>(node->Variable, initializer);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteIfStatement(BoundIfStatement *node)
@@ -66,7 +68,7 @@ BoundStatement *BoundTreeRewriter::RewriteIfStatement(BoundIfStatement *node)
     if (condition == node->Condition && thenStatement == node->ThenStatement && elseStatement == node->ElseStatement)
         return node;
 
-    return new BoundIfStatement(condition, thenStatement, elseStatement);
+    return _arena->New<BoundIfStatement>(condition, thenStatement, elseStatement);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteWhileStatement(BoundWhileStatement *node)
@@ -77,7 +79,7 @@ BoundStatement *BoundTreeRewriter::RewriteWhileStatement(BoundWhileStatement *no
     if (condition == node->Condition && body == node->Body)
         return node;
 
-    return new BoundWhileStatement(condition, body, node->BreakLabel, node->ContinueLabel);
+    return _arena->New<BoundWhileStatement>(condition, body, node->BreakLabel, node->ContinueLabel);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteForStatement(BoundForStatement *node)
@@ -89,7 +91,7 @@ BoundStatement *BoundTreeRewriter::RewriteForStatement(BoundForStatement *node)
     if (lowerBound == node->LowerBound && upperBound == node->UpperBound && body == node->Body)
         return node;
 
-    return new BoundForStatement(node->Variable, lowerBound, upperBound, body, node->BreakLabel, node->ContinueLabel);
+    return _arena->New<BoundForStatement>(node->Variable, lowerBound, upperBound, body, node->BreakLabel, node->ContinueLabel);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteGotoStatement(BoundGotoStatement *node)
@@ -108,7 +110,17 @@ BoundStatement *BoundTreeRewriter::RewriteConditionalGotoStatement(BoundConditio
     if (condition == node->Condition)
         return node;
 
-    return new BoundConditionalGotoStatement(node->Label, condition, node->JumpIfTrue);
+    return _arena->New<BoundConditionalGotoStatement>(node->Label, condition, node->JumpIfTrue);
+}
+
+BoundStatement *BoundTreeRewriter::RewriteCountedGotoStatement(BoundCountedGotoStatement *node)
+{
+    BoundExpression *variable = RewriteExpression(node->Variable);
+    BoundExpression *upperBound = RewriteExpression(node->UpperBound);
+    if (variable == node->Variable && upperBound == node->UpperBound)
+        return node;
+
+    return _arena->New<BoundCountedGotoStatement>(node->Label, variable, upperBound);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteReturnStatement(BoundReturnStatement *node)
@@ -117,7 +129,7 @@ BoundStatement *BoundTreeRewriter::RewriteReturnStatement(BoundReturnStatement *
     if (expression == node->Expression)
         return node;
 
-    return new BoundReturnStatement(expression);
+    return _arena->New<BoundReturnStatement>(expression);
 }
 
 BoundStatement *BoundTreeRewriter::RewriteExpressionStatement(BoundExpressionStatement *node)
@@ -126,7 +138,7 @@ BoundStatement *BoundTreeRewriter::RewriteExpressionStatement(BoundExpressionSta
     if (expression == node->Expression)
         return node;
 
-    return new BoundExpressionStatement(expression);
+    return _arena->New<BoundExpressionStatement>(expression);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteExpression(BoundExpression *node)
@@ -172,7 +184,7 @@ BoundExpression *BoundTreeRewriter::RewriteUnaryExpression(BoundUnaryExpression
     if (operand == node->Operand)
         return node;
 
-    return new BoundUnaryExpression(node->Op, operand);
+    return _arena->New<BoundUnaryExpression>(node->Op, operand);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteBinaryExpression(BoundBinaryExpression *node)
@@ -183,7 +195,7 @@ BoundExpression *BoundTreeRewriter::RewriteBinaryExpression(BoundBinaryExpressio
     if (left == node->Left && right == node->Right)
         return node;
 
-    return new BoundBinaryExpression(left, node->Op, right);
+    return _arena->New<BoundBinaryExpression>(left, node->Op, right);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteCallExpression(BoundCallExpression *node)
@@ -215,7 +227,7 @@ BoundExpression *BoundTreeRewriter::RewriteCallExpression(BoundCallExpression *n
     if (builder == nullptr)
         return node;
 
-    BoundCallExpression *result = new BoundCallExpression(node->Function, *builder);
+    BoundCallExpression *result = _arena->New<BoundCallExpression>(node->Function, *builder);
     delete builder;
     return result;
 }
@@ -226,7 +238,7 @@ BoundExpression *BoundTreeRewriter::RewriteConversionExpression(BoundConversionE
     if (expression == node->Expression)
         return node;
 
-    return new BoundConversionExpression(node->type, expression);
+    return _arena->New<BoundConversionExpression>(node->type, expression);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteLiteralExpression(BoundLiteralExpression *node)
@@ -245,7 +257,7 @@ BoundExpression *BoundTreeRewriter::RewriteAssignmentExpression(BoundAssignmentE
     if (expression == node->Expression)
         return node;
 
-    return new BoundAssignmentExpression(node->Variable, expression);
+    return _arena->New<BoundAssignmentExpression>(node->Variable, expression);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteArrayInitializerExpression(BoundArrayInitializerExpression *node)
@@ -276,7 +288,7 @@ BoundExpression *BoundTreeRewriter::RewriteArrayInitializerExpression(BoundArray
     if (builder == nullptr)
         return node;
 
-    BoundArrayInitializerExpression *result = new BoundArrayInitializerExpression(*builder, node->type);
+    BoundArrayInitializerExpression *result = _arena->New<BoundArrayInitializerExpression>(*builder, node->type);
     delete builder;
     return result;
 }
@@ -289,7 +301,7 @@ BoundExpression *BoundTreeRewriter::RewriteArrayAccessExpression(BoundArrayAcces
     if (variable == node->Variable && index == node->Index)
         return node;
 
-    return new BoundArrayAccessExpression(variable, index);
+    return _arena->New<BoundArrayAccessExpression>(variable, index);
 }
 
 BoundExpression *BoundTreeRewriter::RewriteArrayAssignmentExpression(BoundArrayAssignmentExpression *node)
@@ -301,5 +313,5 @@ BoundExpression *BoundTreeRewriter::RewriteArrayAssignmentExpression(BoundArrayA
     if (identifier == node->Identifier && index == node->Index && expression == node->Expression)
         return node;
 
-    return new BoundArrayAssignmentExpression(identifier, index, expression, node->Variable);
+    return _arena->New<BoundArrayAssignmentExpression>(identifier, index, expression, node->Variable);
 }
\ No newline at end of file
@@ -1,26 +1,38 @@
 #include "CodeAnalysis/Binder.h"
 #include "CodeAnalysis/SyntaxTree.h"
+#include <functional>
 
-BoundUnaryOperator *BoundUnaryOperator::Bind(SyntaxKind syntaxKind, TypeSymbol operandType)
+template <typename Operation, typename Operand, Operand (Value::*Read)() const>
+static Value Apply(const Value &operand)
 {
-    for (auto op : operators)
+    return Value(Operation()((operand.*Read)()));
+}
+
+static Value Identity(const Value &operand)
+{
+    return operand;
+}
+
+const BoundUnaryOperator *BoundUnaryOperator::Bind(SyntaxKind syntaxKind, TypeSymbol operandType)
+{
+    for (const auto &op : operators)
     {
         if (op.syntaxKind == syntaxKind && op.OperandType == operandType)
         {
-            return new BoundUnaryOperator(op.syntaxKind, op.Kind, op.OperandType, op.ResultType);
+            return &op;
         }
     }
     return nullptr;
 }
 
 const std::vector<BoundUnaryOperator> BoundUnaryOperator::operators{
-    BoundUnaryOperator(SyntaxKind::BANG, BoundUnaryOperatorKind::LogicalNegation, TypeSymbol::Boolean),
-    BoundUnaryOperator(SyntaxKind::PLUS, BoundUnaryOperatorKind::Identity, TypeSymbol::Integer),
-    BoundUnaryOperator(SyntaxKind::MINUS, BoundUnaryOperatorKind::Negation, TypeSymbol::Integer),
-    BoundUnaryOperator(SyntaxKind::TILDE, BoundUnaryOperatorKind::OnesComplement, TypeSymbol::Integer),
+    BoundUnaryOperator(SyntaxKind::BANG, BoundUnaryOperatorKind::LogicalNegation, TypeSymbol::Boolean, &Apply<std::logical_not<bool>, bool, &Value::AsBoolean>),
+    BoundUnaryOperator(SyntaxKind::PLUS, BoundUnaryOperatorKind::Identity, TypeSymbol::Integer, Identity),
+    BoundUnaryOperator(SyntaxKind::MINUS, BoundUnaryOperatorKind::Negation, TypeSymbol::Integer, &Apply<std::negate<long long>, long long, &Value::AsInteger>),
+    BoundUnaryOperator(SyntaxKind::TILDE, BoundUnaryOperatorKind::OnesComplement, TypeSymbol::Integer, &Apply<std::bit_not<long long>, long long, &Value::AsInteger>),
 
-    BoundUnaryOperator(SyntaxKind::PLUS, BoundUnaryOperatorKind::Identity, TypeSymbol::Float),
-    BoundUnaryOperator(SyntaxKind::MINUS, BoundUnaryOperatorKind::Negation, TypeSymbol::Float),
+    BoundUnaryOperator(SyntaxKind::PLUS, BoundUnaryOperatorKind::Identity, TypeSymbol::Float, Identity),
+    BoundUnaryOperator(SyntaxKind::MINUS, BoundUnaryOperatorKind::Negation, TypeSymbol::Float, &Apply<std::negate<double>, double, &Value::AsNumber>),
 
 };
 
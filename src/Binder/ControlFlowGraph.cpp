@@ -50,6 +50,16 @@ void ControlFlowGraph::WriteTo(std::ostream &writer) const
     writer << "}" << std::endl;
 }
 
+ControlFlowGraph::~ControlFlowGraph()
+{
+    for (auto *branch : Branches)
+        delete branch;
+    for (auto *block : Blocks)
+        delete block;
+    for (auto *condition : _conditions)
+        delete condition;
+}
+
 ControlFlowGraph *ControlFlowGraph::Create(BoundBlockStatement *body)
 {
     BasicBlockBuilder basicBlockBuilder;
@@ -62,6 +72,7 @@ ControlFlowGraph *ControlFlowGraph::Create(BoundBlockStatement *body)
 bool ControlFlowGraph::AllPathsReturn(BoundBlockStatement *body)
 {
     ControlFlowGraph *graph = Create(body);
+    bool result = true;
 
     for (const auto &branch : graph->End->Incoming)
     {
@@ -69,10 +80,14 @@ bool ControlFlowGraph::AllPathsReturn(BoundBlockStatement *body)
         const auto &lastStatement = branch->From->Statements.back();
 
         if (lastStatement->GetKind() != BoundNodeKind::ReturnStatement)
-            return false;
+        {
+            result = false;
+            break;
+        }
     }
 
-    return true;
+    delete graph;
+    return result;
 }
 
 void ControlFlowGraph::GraphBuilder::Connect(BasicBlock *from, BasicBlock *to, BoundExpression *condition)
@@ -128,6 +143,7 @@ void ControlFlowGraph::GraphBuilder::RemoveBlock(std::vector<BasicBlock *> &bloc
     block->Outgoing.clear();
 
     blocks.erase(std::remove(blocks.begin(), blocks.end(), block), blocks.end());
+    delete block;
 }
 
 BoundExpression *ControlFlowGraph::GraphBuilder::Negate(BoundExpression *condition)
@@ -135,11 +151,13 @@ BoundExpression *ControlFlowGraph::GraphBuilder::Negate(BoundExpression *conditi
     if (auto *literal = dynamic_cast<BoundLiteralExpression *>(condition))
     {
         bool value = (literal->Value == "true");
-        return new BoundLiteralExpression(value ? "false" : "true", TypeSymbol::Boolean);
+        _conditions.push_back(new BoundLiteralExpression(value ? "false" : "true", TypeSymbol::Boolean));
+        return _conditions.back();
     }
 
-    BoundUnaryOperator *op = BoundUnaryOperator::Bind(SyntaxKind::BANG, TypeSymbol::Boolean);
-    return new BoundUnaryExpression(op, condition);
+    const BoundUnaryOperator *op = BoundUnaryOperator::Bind(SyntaxKind::BANG, TypeSymbol::Boolean);
+    _conditions.push_back(new BoundUnaryExpression(op, condition));
+    return _conditions.back();
 }
 
 ControlFlowGraph *ControlFlowGraph::GraphBuilder::Build(std::vector<BasicBlock *> blocks)
@@ -199,6 +217,17 @@ ControlFlowGraph *ControlFlowGraph::GraphBuilder::Build(std::vector<BasicBlock *
                 Connect(current, elseBlock, elseCondition);
                 break;
             }
+            case BoundNodeKind::CountedGotoStatement:
+            {
+                auto *cgs = static_cast<BoundCountedGotoStatement *>(statement);
+                const BoundBinaryOperator *op = BoundBinaryOperator::Bind(SyntaxKind::LESS_EQUALS, TypeSymbol::Integer, TypeSymbol::Integer);
+                BoundExpression *condition = new BoundBinaryExpression(cgs->Variable, op, cgs->UpperBound);
+                _conditions.push_back(condition);
+
+                Connect(current, _blockFromLabel[cgs->Label], condition);
+                Connect(current, next, Negate(condition));
+                break;
+            }
             case BoundNodeKind::ReturnStatement:
             {
                 Connect(current, _end);
@@ -233,7 +262,7 @@ ScanAgain:
     blocks.insert(blocks.begin(), _start);
     blocks.push_back(_end);
 
-    return new ControlFlowGraph(_start, _end, blocks, _branches);
+    return new ControlFlowGraph(_start, _end, blocks, _branches, _conditions);
 }
 
 std::vector<ControlFlowGraph::BasicBlock *> ControlFlowGraph::BasicBlockBuilder::Build(BoundBlockStatement *block)
@@ -249,6 +278,7 @@ std::vector<ControlFlowGraph::BasicBlock *> ControlFlowGraph::BasicBlockBuilder:
 
         case BoundNodeKind::GotoStatement:
         case BoundNodeKind::ConditionalGotoStatement:
+        case BoundNodeKind::CountedGotoStatement:
         case BoundNodeKind::ReturnStatement:
             _statements.push_back(statement);
             StartBlock();
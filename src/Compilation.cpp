@@ -1,5 +1,6 @@
 #include "CodeAnalysis/Binder.h"
 #include "CodeAnalysis/Evaluator.h"
+#include "CodeAnalysis/VirtualMachine.h"
 #include "CodeAnalysis/SyntaxTree.h"
 #include "CodeAnalysis/Diagnostic.h"
 #include "CodeAnalysis/Compilation.h"
@@ -41,6 +42,7 @@ void GenerateCFG(BoundProgram *program)
     {
         std::cerr << "Failed to open file for writing: " << cfgPath << std::endl;
     }
+    delete cfg;
 }
 std::string cConvertBoundNodeKind(BoundNodeKind kind)
 {
@@ -69,7 +71,7 @@ std::string cConvertBoundNodeKind(BoundNodeKind kind)
     }
 }
 
-EvaluationResult Compilation::Evaluate(std::unordered_map<VariableSymbol, std::any> &variables)
+EvaluationResult Compilation::Evaluate(std::unordered_map<VariableSymbol, Value> &variables, ExecutionEngine engine, size_t stackLimit, size_t memoCapacity)
 {
 
     std::vector<Diagnostic> diagnostics;
@@ -80,37 +82,45 @@ EvaluationResult Compilation::Evaluate(std::unordered_map<VariableSymbol, std::a
     }
     if (diagnostics.size() > 0)
     {
-        return EvaluationResult(diagnostics, std::any());
+        return EvaluationResult(diagnostics, Value());
     }
     BoundGlobalScope *globalScope = GlobalScope();
     diagnostics.insert(diagnostics.end(), globalScope->Diagnostics.begin(), globalScope->Diagnostics.end());
 
     if (diagnostics.size() > 0)
     {
-        return EvaluationResult(diagnostics, std::any());
+        return EvaluationResult(diagnostics, Value());
     }
 
-    BoundProgram *program = Binder::BindProgram(globalScope);
+    BoundProgram *program = Program();
 
     // GenerateCFG(program); // Generates Graph for    Control Flow analysis
     if (program->Diagnostics.size() > 0)
     {
         diagnostics.insert(diagnostics.end(), program->Diagnostics.begin(), program->Diagnostics.end());
-        return EvaluationResult(diagnostics, std::any());
+        return EvaluationResult(diagnostics, Value());
     }
 
     // Assembler assembler = Assembler("jay", program, variables);
 
     // assembler.Assemble();
 
-    Evaluator evaluator = Evaluator(program, variables);
+    if (engine == ExecutionEngine::VirtualMachine)
+    {
+        std::unique_ptr<BytecodeProgram> bytecode = BytecodeCompiler::Compile(program);
+        VirtualMachine vm = VirtualMachine(bytecode.get(), variables, stackLimit);
+        Value value = vm.Run();
+        return EvaluationResult(diagnostics, value);
+    }
 
-    std::any value = evaluator.Evaluate();
+    Evaluator evaluator = Evaluator(program, variables, stackLimit, memoCapacity);
+
+    Value value = evaluator.Evaluate();
 
     return EvaluationResult(diagnostics, value);
 }
 
-EvaluationResult Compilation::Compile(std::unordered_map<VariableSymbol, std::any> &variables, std::string outputFileName)
+EvaluationResult Compilation::Compile(std::unordered_map<VariableSymbol, Value> &variables, std::string outputFileName)
 {
 
     std::vector<Diagnostic> diagnostics;
@@ -131,7 +141,7 @@ EvaluationResult Compilation::Compile(std::unordered_map<VariableSymbol, std::an
         return EvaluationResult(diagnostics, 1);
     }
 
-    BoundProgram *program = Binder::BindEmitableProgram(globalScope);
+    BoundProgram *program = EmitableProgram();
 
     // BoundBlockStatement *statement = program->statement;
     // BoundBlockStatement *flatStatement = Lowerer::Flatten(statement);
@@ -179,9 +189,31 @@ BoundGlobalScope *Compilation::GlobalScope()
     return _globalScope;
 };
 
+BoundProgram *Compilation::Program()
+{
+    if (_program == nullptr)
+        _program = Binder::BindProgram(GlobalScope());
+    return _program;
+}
+
+BoundProgram *Compilation::EmitableProgram()
+{
+    if (_emitableProgram == nullptr)
+        _emitableProgram = Binder::BindEmitableProgram(GlobalScope());
+    return _emitableProgram;
+}
+
+void Compilation::ReleasePrograms()
+{
+    delete _program;
+    delete _emitableProgram;
+    _program = nullptr;
+    _emitableProgram = nullptr;
+}
+
 void Compilation::EmitTree(std::ostream &os)
 {
-    BoundProgram *program = Binder::BindProgram(GlobalScope());
+    BoundProgram *program = Program();
 
     if (!program->statement->Statements.empty())
     {
@@ -193,7 +225,7 @@ void Compilation::EmitTree(std::ostream &os)
         {
             if (std::find_if(GlobalScope()->Functions.begin(), GlobalScope()->Functions.end(),
                              [&](const FunctionSymbol &func)
-                             { return func.Name == function.first.Name; }) == GlobalScope()->Functions.end())
+                             { return func == function.first; }) == GlobalScope()->Functions.end())
             {
                 continue;
             }
@@ -205,14 +237,25 @@ void Compilation::EmitTree(std::ostream &os)
 }
 void Compilation::EmitBoundTree(std::ostream &os)
 {
-    BoundProgram *program = Binder::BindProgram(GlobalScope());
+    BoundProgram *program = Program();
 
     if (!program->statement->Statements.empty())
     {
         program->statement->PrintTo(os);
     }
 }
+Compilation::~Compilation()
+{
+    ReleasePrograms();
+    delete _globalScope;
+    for (SyntaxTree *syntaxTree : syntaxTrees)
+        delete syntaxTree;
+}
+
+// Later compilations only need this one's global scope, so the programs
+// bound from it can go.
 Compilation *Compilation::ContinueWith(SyntaxTree *syntaxTree)
 {
+    ReleasePrograms();
     return new Compilation(this, {syntaxTree});
 }
@@ -1,5 +1,6 @@
 #include "CodeGeneration/Emitter.h"
 #include "Utils.h"
+#include <cctype>
 void Emitter::Emit()
 {
     codeStream.open("temp" + Filename + ".cpp");
@@ -63,6 +64,9 @@ void Emitter::EmitStatement(BoundBlockStatement *body)
         case BoundNodeKind::ConditionalGotoStatement:
             EmitConditionalGotoStatement((BoundConditionalGotoStatement *)s);
             break;
+        case BoundNodeKind::CountedGotoStatement:
+            EmitCountedGotoStatement((BoundCountedGotoStatement *)s);
+            break;
         case BoundNodeKind::LabelStatement:
             EmitLabelStatement((BoundLabelStatement *)s);
             break;
@@ -153,6 +157,18 @@ void Emitter::EmitConditionalGotoStatement(BoundConditionalGotoStatement *node)
     }
 }
 
+void Emitter::EmitCountedGotoStatement(BoundCountedGotoStatement *node)
+{
+    codeStream << "if (++";
+    EmitExpression(node->Variable);
+    codeStream << " <= ";
+    EmitExpression(node->UpperBound);
+    codeStream << ")\n";
+    codeStream << "{\n";
+    codeStream << "goto " << node->Label.ToString() << ";\n";
+    codeStream << "}\n";
+}
+
 void Emitter::EmitLabelStatement(BoundLabelStatement *node)
 {
     codeStream << node->Label.ToString() << ":\n";
@@ -303,29 +319,16 @@ void Emitter::EmitConversionExpression(BoundConversionExpression *node)
 }
 void Emitter::EmitCallExpression(BoundCallExpression *node)
 {
-    if (node->Function == BuiltInFunctions::Print)
-    {
-        codeStream << "std::cout << ";
-        EmitExpression(node->Arguments[0]);
-    }
-    else if (node->Function == BuiltInFunctions::ArrayLength)
+    if (node->Function.BuiltIn >= 0)
     {
-        EmitExpression(node->Arguments[0]);
-        codeStream << ".size()";
-    }
-    else if (node->Function == BuiltInFunctions::StringLength)
-    {
-        EmitExpression(node->Arguments[0]);
-        codeStream << ".size()";
-    }
-    else if (node->Function == BuiltInFunctions::Random)
-    {
-        codeStream << "rand() % ";
-        EmitExpression(node->Arguments[0]);
-    }
-    else if (node->Function == BuiltInFunctions::Input)
-    {
-        codeStream << "";
+        const std::string &text = BuiltInFunctions::GetAll()[node->Function.BuiltIn].Template;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '$' && i + 1 < text.size() && std::isdigit(text[i + 1]))
+                EmitExpression(node->Arguments[text[++i] - '0']);
+            else
+                codeStream << text[i];
+        }
     }
     else
     {
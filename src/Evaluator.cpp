@@ -1,9 +1,12 @@
 #include "CodeAnalysis/Evaluator.h"
+#include "CodeAnalysis/Lowerer.h"
 #include "CodeAnalysis/Symbol.h"
 #include "Utils.h"
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 std::string convertBoundNodeKind(BoundNodeKind kind)
 {
@@ -39,6 +42,8 @@ std::string convertBoundNodeKind(BoundNodeKind kind)
         return "LabelStatement";
     case BoundNodeKind::ConditionalGotoStatement:
         return "ConditionalGotoStatement";
+    case BoundNodeKind::CountedGotoStatement:
+        return "CountedGotoStatement";
     case BoundNodeKind::ReturnStatement:
         return "ReturnStatement";
     default:
@@ -46,76 +51,364 @@ std::string convertBoundNodeKind(BoundNodeKind kind)
     }
 }
 
-std::any Evaluator::EvaluateStatement(BoundBlockStatement *body)
+Value Evaluator::Evaluate()
 {
-    std::unordered_map<BoundLabel, int> labelToIndex;
+    _globals.resize(_program->GlobalCount);
+    for (const auto &[variable, value] : _variables)
+    {
+        if (variable.Slot >= 0 && static_cast<size_t>(variable.Slot) < _globals.size())
+            _globals[variable.Slot] = value;
+    }
 
-    for (int i = 0; i < body->Statements.size(); i++)
+    if (_memoCapacity > 0)
     {
-        if (body->Statements[i]->GetKind() == BoundNodeKind::LabelStatement)
+        for (auto &function : _program->PureFunctions)
         {
-            BoundLabelStatement *label = static_cast<BoundLabelStatement *>(body->Statements[i]);
-            labelToIndex[label->Label] = i + 1;
+            bool scalar = function.Type != TypeSymbol::Void;
+            for (auto &parameter : function.Parameters)
+            {
+                scalar = scalar && (parameter.Type == TypeSymbol::Integer || parameter.Type == TypeSymbol::Float ||
+                                    parameter.Type == TypeSymbol::Boolean || parameter.Type == TypeSymbol::String);
+            }
+            if (scalar)
+                _memoBodies.insert(_program->Functions[function]);
         }
     }
 
-    int index = 0;
-    while (index < body->Statements.size())
+    _locals.resize(_program->statement->LocalCount);
+    _frames.push_back({_program->statement, 0, 0, false});
+    Value result = Run(0);
+
+    for (const auto &variable : _program->Globals)
     {
-        BoundStatement *s = body->Statements[index];
+        _variables.erase(variable);
+        _variables.emplace(variable, _globals[variable.Slot]);
+    }
+    return result;
+}
 
-        switch (s->GetKind())
-        {
-        case BoundNodeKind::VariableDeclaration:
-            EvaluateVariableDeclaration((BoundVariableDeclaration *)s);
-            index++;
-            break;
-        case BoundNodeKind::ExpressionStatement:
-            EvaluateExpressionStatement((BoundExpressionStatement *)s);
-            index++;
-            break;
-        case BoundNodeKind::GotoStatement:
-        {
-            BoundGotoStatement *gs = (BoundGotoStatement *)s;
-            index = labelToIndex[gs->Label];
-            break;
-        }
-        case BoundNodeKind::ConditionalGotoStatement:
+static bool ValuesEqual(const Value &left, const Value &right)
+{
+    if (left.IsInteger() && right.IsInteger())
+        return left.AsInteger() == right.AsInteger();
+    if ((left.IsInteger() || left.IsFloat()) && (right.IsInteger() || right.IsFloat()))
+        return left.AsNumber() == right.AsNumber();
+    if (left.IsBoolean() && right.IsBoolean())
+        return left.AsBoolean() == right.AsBoolean();
+    if (left.IsString() && right.IsString())
+        return left.AsString() == right.AsString();
+    throw std::runtime_error("Unexpected types for equality comparison");
+}
+
+// Memo keys compare floats by their bits, so that a NaN argument finds its
+// own entry again and can be evicted.
+static uint64_t FloatBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static BoundCallExpression *AsUserCall(BoundExpression *node)
+{
+    if (node->GetKind() != BoundNodeKind::CallExpression)
+        return nullptr;
+
+    BoundCallExpression *call = (BoundCallExpression *)node;
+    return call->Body == nullptr ? nullptr : call;
+}
+
+// Runs frames until the stack is back to the given depth. Calls lifted to
+// statement level push a frame instead of recursing, and the statement is
+// finished by CompleteCall once the callee returns.
+Value Evaluator::Run(size_t depth)
+{
+    while (true)
+    {
+        Frame &frame = _frames.back();
+        const std::vector<BoundStatement *> &statements = frame.Body->Statements;
+        size_t index = frame.Index;
+        bool called = false;
+
+        while (index < statements.size() && !called)
         {
-            BoundConditionalGotoStatement *cgs = (BoundConditionalGotoStatement *)s;
-            bool condition = std::any_cast<bool>(EvaluateExpression(cgs->Condition));
-            if ((condition == cgs->JumpIfTrue))
+            BoundStatement *s = statements[index];
+
+            switch (s->GetKind())
+            {
+            case BoundNodeKind::VariableDeclaration:
             {
-                index = labelToIndex[cgs->Label];
+                BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)s;
+                if (BoundCallExpression *call = AsUserCall(declaration->Initializer))
+                {
+                    frame.Index = index;
+                    called = PushFrame(call);
+                    if (!called)
+                    {
+                        CompleteCall(std::move(_callResult));
+                        index = frame.Index;
+                    }
+                    break;
+                }
+                EvaluateVariableDeclaration(declaration);
+                index++;
+                break;
             }
-            else
+            case BoundNodeKind::ExpressionStatement:
             {
+                BoundExpression *expression = ((BoundExpressionStatement *)s)->Expression;
+                if (expression->GetKind() == BoundNodeKind::AssignmentExpression)
+                    expression = ((BoundAssignmentExpression *)expression)->Expression;
+                if (BoundCallExpression *call = AsUserCall(expression))
+                {
+                    frame.Index = index;
+                    called = PushFrame(call);
+                    if (!called)
+                    {
+                        CompleteCall(std::move(_callResult));
+                        index = frame.Index;
+                    }
+                    break;
+                }
+                EvaluateExpressionStatement((BoundExpressionStatement *)s);
                 index++;
+                break;
+            }
+            case BoundNodeKind::GotoStatement:
+            {
+                index = ((BoundGotoStatement *)s)->Target;
+                break;
+            }
+            case BoundNodeKind::ConditionalGotoStatement:
+            {
+                BoundConditionalGotoStatement *cgs = (BoundConditionalGotoStatement *)s;
+                bool condition = EvaluateExpression(cgs->Condition).AsBoolean();
+                if ((condition == cgs->JumpIfTrue))
+                {
+                    index = cgs->Target;
+                }
+                else
+                {
+                    index++;
+                }
+                break;
+            }
+            case BoundNodeKind::CountedGotoStatement:
+            {
+                BoundCountedGotoStatement *cgs = (BoundCountedGotoStatement *)s;
+                Value &variable = Lookup(((BoundVariableExpression *)cgs->Variable)->Variable);
+                long long next = variable.AsInteger() + 1;
+                variable = Value(next);
+                if (next <= EvaluateExpression(cgs->UpperBound).AsInteger())
+                    index = cgs->Target;
+                else
+                    index++;
+                break;
+            }
+            case BoundNodeKind::LabelStatement:
+                index++;
+                break;
+            case BoundNodeKind::ReturnStatement:
+            {
+                BoundReturnStatement *rs = (BoundReturnStatement *)s;
+                if (rs->Expression != nullptr)
+                {
+                    BoundCallExpression *call = AsUserCall(rs->Expression);
+                    if (call != nullptr && !_memoBodies.empty() && _memoBodies.count(call->Body))
+                    {
+                        frame.Index = index;
+                        called = PushFrame(call);
+                        if (!called)
+                        {
+                            CompleteCall(std::move(_callResult));
+                            index = frame.Index;
+                        }
+                        break;
+                    }
+                    if (call != nullptr)
+                    {
+                        ReplaceFrame(call);
+                        called = true;
+                        break;
+                    }
+                }
+                _lastValue = rs->Expression == nullptr ? Value() : EvaluateExpression(rs->Expression);
+                index = statements.size();
+                break;
+            }
+            default:
+                throw std::runtime_error("Unexpected node kind2: " + convertBoundNodeKindToString(s->GetKind()));
             }
-            break;
         }
-        case BoundNodeKind::LabelStatement:
-            index++;
-            break;
-        case BoundNodeKind::ReturnStatement:
+
+        if (called)
+            continue;
+
+        Value result = _lastValue;
+        if (frame.Memoized)
+        {
+            Remember(std::move(_memoKeys.back()), result);
+            _memoKeys.pop_back();
+        }
+        _locals.resize(frame.Base);
+        _frames.pop_back();
+        _frameBase = _frames.empty() ? 0 : _frames.back().Base;
+
+        if (_frames.size() == depth)
+            return result;
+        CompleteCall(std::move(result));
+    }
+}
+
+// Returns false when a memoized result is used instead, leaving it in
+// _callResult.
+bool Evaluator::PushFrame(BoundCallExpression *call)
+{
+    BoundBlockStatement *body = call->Body;
+    size_t base = _locals.size();
+    _locals.resize(base + body->LocalCount);
+
+    for (size_t i = 0; i < call->Arguments.size(); i++)
+    {
+        Value argument = EvaluateExpression(call->Arguments[i]);
+        _locals[base + i] = std::move(argument);
+    }
+
+    bool memoized = !_memoBodies.empty() && _memoBodies.count(body);
+    if (memoized)
+    {
+        MemoKey key{body, std::vector<Value>(_locals.begin() + base, _locals.begin() + base + call->Arguments.size())};
+        auto it = _memoIndex.find(key);
+        if (it != _memoIndex.end())
         {
-            BoundReturnStatement *rs = (BoundReturnStatement *)s;
-            _lastValue = rs->Expression == nullptr ? std::any() : EvaluateExpression(rs->Expression);
-            return _lastValue;
+            _memoEntries.splice(_memoEntries.begin(), _memoEntries, it->second);
+            _callResult = it->second->second;
+            _locals.resize(base);
+            return false;
         }
+        _memoKeys.push_back(std::move(key));
+    }
+
+    _frames.push_back({body, 0, base, memoized});
+    _frameBase = base;
+    if (_locals.size() * sizeof(Value) + _frames.size() * sizeof(Frame) > _stackLimit)
+        throw std::runtime_error("Stack overflow");
+    return true;
+}
+
+void Evaluator::Remember(MemoKey key, const Value &value)
+{
+    auto it = _memoIndex.find(key);
+    if (it != _memoIndex.end())
+    {
+        it->second->second = value;
+        return;
+    }
+
+    _memoEntries.emplace_front(std::move(key), value);
+    _memoIndex.emplace(_memoEntries.front().first, _memoEntries.begin());
+    if (_memoEntries.size() > _memoCapacity)
+    {
+        _memoIndex.erase(_memoEntries.back().first);
+        _memoEntries.pop_back();
+    }
+}
+
+bool Evaluator::MemoKey::operator==(const MemoKey &other) const
+{
+    if (Body != other.Body || Arguments.size() != other.Arguments.size())
+        return false;
+
+    for (size_t i = 0; i < Arguments.size(); i++)
+    {
+        const Value &left = Arguments[i];
+        const Value &right = other.Arguments[i];
+        if (left.GetKind() != right.GetKind())
+            return false;
+        if (left.IsFloat() ? FloatBits(left.AsFloat()) != FloatBits(right.AsFloat()) : !ValuesEqual(left, right))
+            return false;
+    }
+    return true;
+}
+
+size_t Evaluator::MemoKeyHash::operator()(const MemoKey &key) const
+{
+    size_t hash = std::hash<BoundBlockStatement *>()(key.Body);
+    for (auto &argument : key.Arguments)
+    {
+        size_t element = 0;
+        switch (argument.GetKind())
+        {
+        case ValueKind::Integer:
+            element = std::hash<long long>()(argument.AsInteger());
+            break;
+        case ValueKind::Float:
+            element = std::hash<uint64_t>()(FloatBits(argument.AsFloat()));
+            break;
+        case ValueKind::Boolean:
+            element = std::hash<bool>()(argument.AsBoolean());
+            break;
+        case ValueKind::String:
+            element = std::hash<std::string>()(argument.AsString());
+            break;
         default:
-            throw std::runtime_error("Unexpected node kind2: " + convertBoundNodeKindToString(s->GetKind()));
+            break;
         }
+        hash ^= element + 0x9e3779b9 + (hash << 6) + (hash >> 2);
     }
+    return hash;
+}
 
-    return _lastValue;
+// return f(...) reuses the frame of the function that is returning.
+void Evaluator::ReplaceFrame(BoundCallExpression *call)
+{
+    std::vector<Value> arguments;
+    arguments.swap(_arguments);
+    for (auto &argument : call->Arguments)
+        arguments.push_back(EvaluateExpression(argument));
+
+    Frame &frame = _frames.back();
+    frame.Body = call->Body;
+    frame.Index = 0;
+    _locals.resize(frame.Base);
+    _locals.resize(frame.Base + frame.Body->LocalCount);
+    for (size_t i = 0; i < arguments.size(); i++)
+        _locals[frame.Base + i] = std::move(arguments[i]);
+
+    arguments.clear();
+    arguments.swap(_arguments);
+    if (_locals.size() * sizeof(Value) + _frames.size() * sizeof(Frame) > _stackLimit)
+        throw std::runtime_error("Stack overflow");
+}
+
+void Evaluator::CompleteCall(Value value)
+{
+    Frame &frame = _frames.back();
+    BoundStatement *s = frame.Body->Statements[frame.Index++];
+    if (s->GetKind() == BoundNodeKind::ReturnStatement)
+    {
+        _lastValue = std::move(value);
+        frame.Index = frame.Body->Statements.size();
+        return;
+    }
+    if (s->GetKind() == BoundNodeKind::VariableDeclaration)
+    {
+        _lastValue = value;
+        Assign(((BoundVariableDeclaration *)s)->Variable, std::move(value));
+        return;
+    }
+
+    BoundExpression *expression = ((BoundExpressionStatement *)s)->Expression;
+    if (expression->GetKind() == BoundNodeKind::AssignmentExpression)
+        Assign(((BoundAssignmentExpression *)expression)->Variable, value);
+    _lastValue = std::move(value);
 }
 
 void Evaluator::EvaluateVariableDeclaration(BoundVariableDeclaration *node)
 {
-    std::any value = EvaluateExpression(node->Initializer);
+    Value value = EvaluateExpression(node->Initializer);
     _lastValue = value;
-    Assign(node->Variable, value);
+    Assign(node->Variable, std::move(value));
 }
 
 void Evaluator::EvaluateExpressionStatement(BoundExpressionStatement *node)
@@ -124,7 +417,7 @@ void Evaluator::EvaluateExpressionStatement(BoundExpressionStatement *node)
     _lastValue = EvaluateExpression(node->Expression);
 }
 
-std::any Evaluator::EvaluateExpression(BoundExpression *node)
+Value Evaluator::EvaluateExpression(BoundExpression *node)
 {
 
     switch (node->GetKind())
@@ -154,30 +447,24 @@ std::any Evaluator::EvaluateExpression(BoundExpression *node)
     }
 }
 
-std::any Evaluator::EvaluateLiteralExpression(BoundLiteralExpression *n)
+Value Evaluator::EvaluateLiteralExpression(BoundLiteralExpression *n)
 {
-    if (n->type == TypeSymbol::Boolean)
-        return std::any(n->Value == "true");
-    if (n->type == TypeSymbol::String)
-        return std::any(n->Value);
-    if (n->type == TypeSymbol::Float)
-        return std::any(std::stod(n->Value));
-
-    return std::any(std::stoll(n->Value));
+    if (n->ConstantIndex < 0)
+        return ConstantPool::Decode(n);
+    return _program->Constants[n->ConstantIndex];
 }
 
-std::any Evaluator::EvaluateVariableExpression(BoundVariableExpression *n)
+Value Evaluator::EvaluateVariableExpression(BoundVariableExpression *n)
 {
 
     if (n->Variable.GetKind() == SymbolKind::GlobalVariable)
     {
 
-        return _globals[n->Variable];
+        return _globals[n->Variable.Slot];
     }
     else if (n->Variable.GetKind() == SymbolKind::LocalVariable)
     {
-        std::unordered_map<VariableSymbol, std::any> locals = _locals.top();
-        return locals[n->Variable];
+        return _locals[_frameBase + n->Variable.Slot];
     }
     else
     {
@@ -185,398 +472,215 @@ std::any Evaluator::EvaluateVariableExpression(BoundVariableExpression *n)
     }
 }
 
-std::any Evaluator::EvaluateAssignmentExpression(BoundAssignmentExpression *n)
+Value Evaluator::EvaluateAssignmentExpression(BoundAssignmentExpression *n)
 {
-    std::any value = EvaluateExpression(n->Expression);
+    Value value = EvaluateExpression(n->Expression);
     Assign(n->Variable, value);
     return value;
 }
 
-std::any Evaluator::EvaluateUnaryExpression(BoundUnaryExpression *n)
+Value Evaluator::EvaluateUnaryExpression(BoundUnaryExpression *n)
 {
-    auto operand = EvaluateExpression(n->Operand);
-
-    switch (n->Op->Kind)
-    {
-    case BoundUnaryOperatorKind::Identity:
-        if (n->Op->OperandType == TypeSymbol::Integer)
-            return std::any_cast<long long>(operand);
-        else if (n->Op->OperandType == TypeSymbol::Float)
-            return std::any_cast<double>(operand);
-        else
-            return std::any_cast<std::string>(operand);
-    case BoundUnaryOperatorKind::Negation:
-        if (n->Op->OperandType == TypeSymbol::Integer)
-            return -std::any_cast<long long>(operand);
-        else if (n->Op->OperandType == TypeSymbol::Float)
-            return -std::any_cast<double>(operand);
-        else
-            throw std::runtime_error("Unexpected unary operator");
-    case BoundUnaryOperatorKind::LogicalNegation:
-        return !std::any_cast<bool>(operand);
-    case BoundUnaryOperatorKind::OnesComplement:
-        return ~std::any_cast<long long>(operand);
-    default:
-        throw std::runtime_error("Unexpected unary operator");
-    }
+    return n->Op->Handler(EvaluateExpression(n->Operand));
 }
 
-std::any Evaluator::EvaluateBinaryExpression(BoundBinaryExpression *n)
+Value Evaluator::EvaluateBinaryExpression(BoundBinaryExpression *n)
 {
-    auto left = EvaluateExpression(n->Left);
-    auto right = EvaluateExpression(n->Right);
-
-    switch (n->Op->Kind)
-    {
-    case BoundBinaryOperatorKind::Addition:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) + std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) + std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) + std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::String && n->Op->RightType == TypeSymbol::String)
-            return std::any_cast<std::string>(left) + std::any_cast<std::string>(right);
-        if (n->Op->LeftType == TypeSymbol::String && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<std::string>(left) + std::to_string(std::any_cast<long long>(right));
-        if (n->Op->LeftType == TypeSymbol::String && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<std::string>(left) + std::to_string(std::any_cast<double>(right));
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::String)
-            return std::to_string(std::any_cast<long long>(left)) + std::any_cast<std::string>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::String)
-            return std::to_string(std::any_cast<double>(left)) + std::any_cast<std::string>(right);
-        return std::any_cast<double>(left) + std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::Subtraction:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-        {
-            if (left.type() == typeid(long long) && right.type() == typeid(long long))
-                return std::any_cast<long long>(left) - std::any_cast<long long>(right);
-            if (left.type() == typeid(int) && right.type() == typeid(int))
-                return (long long)std::any_cast<int>(left) - std::any_cast<int>(right);
-            if (left.type() == typeid(long long) && right.type() == typeid(int))
-                return (long long)std::any_cast<long long>(left) - std::any_cast<int>(right);
-            if (left.type() == typeid(int) && right.type() == typeid(long long))
-                return (long long)std::any_cast<int>(left) - std::any_cast<long long>(right);
-        }
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) - std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) - std::any_cast<long long>(right);
-        return std::any_cast<double>(left) - std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::Multiplication:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) * std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) * std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) * std::any_cast<long long>(right);
-        return std::any_cast<double>(left) * std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::Division:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) / std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) / std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) / std::any_cast<long long>(right);
-        return std::any_cast<double>(left) / std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::BitwiseAnd:
-        if (n->Op->LeftType == TypeSymbol::Boolean && n->Op->RightType == TypeSymbol::Boolean)
-        {
-            return std::any_cast<bool>(left) & std::any_cast<bool>(right);
-        }
-        return std::any_cast<long long>(left) & std::any_cast<long long>(right);
-    case BoundBinaryOperatorKind::BitwiseOr:
-        if (n->Op->LeftType == TypeSymbol::Boolean && n->Op->RightType == TypeSymbol::Boolean)
-            return std::any_cast<bool>(left) | std::any_cast<bool>(right);
-        return std::any_cast<long long>(left) | std::any_cast<long long>(right);
-    case BoundBinaryOperatorKind::BitwiseXor:
-        if (n->Op->LeftType == TypeSymbol::Boolean && n->Op->RightType == TypeSymbol::Boolean)
-            return std::any_cast<bool>(left) ^ std::any_cast<bool>(right);
-        return std::any_cast<long long>(left) ^ std::any_cast<long long>(right);
-    case BoundBinaryOperatorKind::LogicalAnd:
-        return std::any_cast<bool>(left) && std::any_cast<bool>(right);
-    case BoundBinaryOperatorKind::LogicalOr:
-        return std::any_cast<bool>(left) || std::any_cast<bool>(right);
-    case BoundBinaryOperatorKind::Less:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) < std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) < std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) < std::any_cast<long long>(right);
-        return std::any_cast<double>(left) < std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::LessOrEquals:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) <= std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) <= std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) <= std::any_cast<long long>(right);
-        return std::any_cast<double>(left) <= std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::Greater:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) > std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) > std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) > std::any_cast<long long>(right);
-        return std::any_cast<double>(left) > std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::GreaterOrEquals:
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<long long>(left) >= std::any_cast<long long>(right);
-        if (n->Op->LeftType == TypeSymbol::Integer && n->Op->RightType == TypeSymbol::Float)
-            return std::any_cast<long long>(left) >= std::any_cast<double>(right);
-        if (n->Op->LeftType == TypeSymbol::Float && n->Op->RightType == TypeSymbol::Integer)
-            return std::any_cast<double>(left) >= std::any_cast<long long>(right);
-        return std::any_cast<double>(left) >= std::any_cast<double>(right);
-    case BoundBinaryOperatorKind::Equals:
-        if (left.type() == typeid(long long) && right.type() == typeid(long long))
-            return std::any_cast<long long>(left) == std::any_cast<long long>(right);
-        if (left.type() == typeid(double) && right.type() == typeid(double))
-            return std::any_cast<double>(left) == std::any_cast<double>(right);
-        if (left.type() == typeid(long long) && right.type() == typeid(double))
-            return std::any_cast<long long>(left) == std::any_cast<double>(right);
-        if (left.type() == typeid(double) && right.type() == typeid(long long))
-            return std::any_cast<double>(left) == std::any_cast<long long>(right);
-        if (left.type() == typeid(bool) && right.type() == typeid(bool))
-            return std::any_cast<bool>(left) == std::any_cast<bool>(right);
-        if (left.type() == typeid(std::string) && right.type() == typeid(std::string))
-            return std::any_cast<std::string>(left) == std::any_cast<std::string>(right);
-        throw std::runtime_error("Unexpected types for equality comparison");
-    case BoundBinaryOperatorKind::NotEquals:
-        if (left.type() == typeid(long long) && right.type() == typeid(long long))
-            return std::any_cast<long long>(left) != std::any_cast<long long>(right);
-        if (left.type() == typeid(double) && right.type() == typeid(double))
-            return std::any_cast<double>(left) != std::any_cast<double>(right);
-        if (left.type() == typeid(long long) && right.type() == typeid(double))
-            return std::any_cast<long long>(left) != std::any_cast<double>(right);
-        if (left.type() == typeid(double) && right.type() == typeid(long long))
-            return std::any_cast<double>(left) != std::any_cast<long long>(right);
-        if (left.type() == typeid(bool) && right.type() == typeid(bool))
-            return std::any_cast<bool>(left) != std::any_cast<bool>(right);
-        if (left.type() == typeid(std::string) && right.type() == typeid(std::string))
-            return std::any_cast<std::string>(left) != std::any_cast<std::string>(right);
-        throw std::runtime_error("Unexpected types for inequality comparison");
-    default:
-        throw std::runtime_error("Unexpected binary operator");
-    }
+    if (n->Op->Kind == BoundBinaryOperatorKind::LogicalAnd)
+        return Value(EvaluateExpression(n->Left).AsBoolean() && EvaluateExpression(n->Right).AsBoolean());
+    if (n->Op->Kind == BoundBinaryOperatorKind::LogicalOr)
+        return Value(EvaluateExpression(n->Left).AsBoolean() || EvaluateExpression(n->Right).AsBoolean());
+
+    Value left = EvaluateExpression(n->Left);
+    Value right = EvaluateExpression(n->Right);
+    return n->Op->Handler(left, right);
 }
 
-std::any Evaluator::EvaluateCallExpression(BoundCallExpression *n)
+Value Evaluator::EvaluateCallExpression(BoundCallExpression *n)
 {
-    if (n->Function == BuiltInFunctions::Input)
+    if (n->Body == nullptr)
     {
-        std::string input;
-        std::cin >> input;
-        std::cout << "\n";
-        return input;
+        std::vector<Value> arguments;
+        for (auto &argument : n->Arguments)
+            arguments.push_back(EvaluateExpression(argument));
+        return CallBuiltInFunction(n->Function, arguments.data());
     }
-    else if (n->Function == BuiltInFunctions::Print)
-    {
-        std::string output = std::any_cast<std::string>(EvaluateExpression(n->Arguments[0]));
-        std::cout << output;
-        return output;
-    }
-    else if (n->Function == BuiltInFunctions::ArrayLength)
-    {
-        std::vector<std::any> array = std::any_cast<std::vector<std::any>>(EvaluateExpression(n->Arguments[0]));
-        long long size = array.size();
-        return size;
-    }
-    else if (n->Function == BuiltInFunctions::StringLength)
-    {
-        std::string text = std::any_cast<std::string>(EvaluateExpression(n->Arguments[0]));
-        long long size = text.size();
-        return size;
-    }
-    else if (n->Function == BuiltInFunctions::Random)
-    {
-        long long max = std::any_cast<long long>(EvaluateExpression(n->Arguments[0]));
-        return rand() % max;
-    }
-    else
-    {
-        std::unordered_map<VariableSymbol, std::any> locals;
-
-        for (long long i = 0; i < n->Arguments.size(); i++)
-        {
-            locals[n->Function.Parameters[i]] = EvaluateExpression(n->Arguments[i]);
-        }
-
-        _locals.push(locals);
 
-        BoundBlockStatement *statement = _program->Functions[n->Function];
-        std::any result = EvaluateStatement(statement);
-
-        _locals.pop();
+    size_t depth = _frames.size();
+    if (!PushFrame(n))
+        return std::move(_callResult);
+    return Run(depth);
+}
 
-        return result;
-    }
+Value Evaluator::EvaluateConversionExpression(BoundConversionExpression *n)
+{
+    return ApplyConversion(n->type, EvaluateExpression(n->Expression));
 }
 
-std::any Evaluator::EvaluateConversionExpression(BoundConversionExpression *n)
+Value Evaluator::ApplyConversion(const TypeSymbol &type, const Value &value)
 {
-    auto value = EvaluateExpression(n->Expression);
-    if (n->type == TypeSymbol::Boolean)
-    {
-        if (n->Expression->type == TypeSymbol::Boolean)
-            return std::any_cast<bool>(value);
-        else if (n->Expression->type == TypeSymbol::Integer)
-            return std::any_cast<long long>(value) != 0;
-        else if (n->Expression->type == TypeSymbol::Float)
-            return std::any_cast<double>(value) != 0.0;
-        else if (n->Expression->type == TypeSymbol::String)
-            return std::any_cast<std::string>(value) != "";
-        else if (n->Expression->type == TypeSymbol::Any)
-            return value.has_value();
-    }
-    else if (n->type == TypeSymbol::String)
+    if (type == TypeSymbol::Boolean)
     {
-        if (n->Expression->type == TypeSymbol::Boolean)
-            return std::to_string(std::any_cast<bool>(value));
-        else if (n->Expression->type == TypeSymbol::Integer)
-            return std::to_string(std::any_cast<long long>(value));
-        else if (n->Expression->type == TypeSymbol::Float)
-            return std::to_string(std::any_cast<double>(value));
-        else if (n->Expression->type == TypeSymbol::String)
-            return std::any_cast<std::string>(value);
-        else if (n->Expression->type == TypeSymbol::Any)
+        switch (value.GetKind())
         {
-            if (value.type() == typeid(bool))
-                return std::to_string(std::any_cast<bool>(value));
-            else if (value.type() == typeid(int))
-                return std::to_string(std::any_cast<int>(value));
-            else if (value.type() == typeid(long long))
-                return std::to_string(std::any_cast<long long>(value));
-            else if (value.type() == typeid(float))
-                return std::to_string(std::any_cast<double>(value));
-            else if (value.type() == typeid(double))
-                return std::to_string(std::any_cast<double>(value));
-            else if (value.type() == typeid(std::string))
-                return std::any_cast<std::string>(value);
-            else if (value.type() == typeid(std::any))
-                return "any";
+        case ValueKind::Boolean:
+            return value;
+        case ValueKind::Integer:
+            return Value(value.AsInteger() != 0);
+        case ValueKind::Float:
+            return Value(value.AsFloat() != 0.0);
+        case ValueKind::String:
+            return Value(value.AsString() != "");
+        default:
+            return Value(value.HasValue());
         }
     }
-    else if (n->type == TypeSymbol::Integer)
+    else if (type == TypeSymbol::String)
     {
-        if (n->Expression->type == TypeSymbol::Boolean)
-            return std::any_cast<bool>(value);
-        else if (n->Expression->type == TypeSymbol::String)
-            return std::stoll(std::any_cast<std::string>(value));
-        else if (n->Expression->type == TypeSymbol::Integer)
-            return std::any_cast<long long>(value);
-        else if (n->Expression->type == TypeSymbol::Float)
-            return (long long)std::any_cast<double>(value);
-        else if (n->Expression->type == TypeSymbol::Any)
-            return std::any_cast<long long>(value);
+        if (value.IsString())
+            return value;
+        return Value(value.ToString());
     }
-    else if (n->type == TypeSymbol::Float)
+    else if (type == TypeSymbol::Integer)
     {
-        if (n->Expression->type == TypeSymbol::Boolean)
-            return std::any_cast<bool>(value);
-        else if (n->Expression->type == TypeSymbol::String)
-            return std::stod(std::any_cast<std::string>(value));
-        else if (n->Expression->type == TypeSymbol::Integer)
-            return (double)std::any_cast<long long>(value);
-        else if (n->Expression->type == TypeSymbol::Float)
-            return std::any_cast<double>(value);
-        else if (n->Expression->type == TypeSymbol::Any)
-            return std::any_cast<double>(value);
+        switch (value.GetKind())
+        {
+        case ValueKind::Boolean:
+            return Value((long long)value.AsBoolean());
+        case ValueKind::String:
+            try
+            {
+                return Value(std::stoll(value.AsString()));
+            }
+            catch (const std::logic_error &)
+            {
+                throw std::runtime_error("Cannot convert '" + value.AsString() + "' to int");
+            }
+        case ValueKind::Float:
+            return Value((long long)value.AsFloat());
+        default:
+            return value;
+        }
     }
-    else if (n->type == TypeSymbol::Any)
+    else if (type == TypeSymbol::Float)
     {
-        if (n->Expression->type == TypeSymbol::Boolean)
-            return std::any_cast<bool>(value);
-        else if (n->Expression->type == TypeSymbol::String)
-            return std::any_cast<std::string>(value);
-        else if (n->Expression->type == TypeSymbol::Integer)
-            return std::any_cast<long long>(value);
-        else if (n->Expression->type == TypeSymbol::Float)
-            return std::any_cast<double>(value);
-        else if (n->Expression->type == TypeSymbol::Any)
+        switch (value.GetKind())
+        {
+        case ValueKind::Boolean:
+            return Value((double)value.AsBoolean());
+        case ValueKind::String:
+            try
+            {
+                return Value(std::stod(value.AsString()));
+            }
+            catch (const std::logic_error &)
+            {
+                throw std::runtime_error("Cannot convert '" + value.AsString() + "' to float");
+            }
+        case ValueKind::Integer:
+            return Value((double)value.AsInteger());
+        default:
             return value;
+        }
     }
-    else if (n->type == TypeSymbol::ArrayAny)
+    else if (type == TypeSymbol::Any || type == TypeSymbol::ArrayAny)
     {
-        if (n->Expression->type.IsArray())
-            return std::any_cast<std::vector<std::any>>(value);
+        return value;
     }
     else
-        throw std::runtime_error("Unexpected conversion: " + n->type.Name);
-
-    return std::any();
+        throw std::runtime_error("Unexpected conversion: " + type.Name);
 }
 
-std::any Evaluator::EvaluateArrayAccessExpression(BoundArrayAccessExpression *n)
+Value Evaluator::EvaluateArrayAccessExpression(BoundArrayAccessExpression *n)
 {
-    long long index = std::any_cast<long long>(EvaluateExpression(n->Index));
-    if (n->type == TypeSymbol::String)
-    {
-        std::string array = std::any_cast<std::string>(EvaluateExpression(n->Variable));
-        if (index < 0 || index >= array.size())
-            throw std::runtime_error("Index out of bounds");
-        return std::string(1, array[index]);
-    }
-    else
-    {
-
-        std::vector<std::any> array = std::any_cast<std::vector<std::any>>(EvaluateExpression(n->Variable));
-        if (index < 0 || index >= array.size())
-            throw std::runtime_error("Index out of bounds");
-        return array[index];
-    }
+    long long index = EvaluateExpression(n->Index).AsInteger();
+    if (n->Variable->GetKind() == BoundNodeKind::VariableExpression)
+        return LoadElement(Lookup(((BoundVariableExpression *)n->Variable)->Variable), index);
+    return LoadElement(EvaluateExpression(n->Variable), index);
 }
 
-std::any Evaluator::EvaluateArrayInitializerExpression(BoundArrayInitializerExpression *n)
+Value Evaluator::EvaluateArrayInitializerExpression(BoundArrayInitializerExpression *n)
 {
-    std::vector<std::any> values;
+    std::vector<Value> values;
+    values.reserve(n->Elements.size());
     for (auto &expression : n->Elements)
     {
         values.push_back(EvaluateExpression(expression));
     }
-    return values;
+    return Value(GetElementKind(n->type), values.data(), values.size());
 }
 
-std::any Evaluator::EvaluateArrayAssignmentExpression(BoundArrayAssignmentExpression *n)
+Value Evaluator::EvaluateArrayAssignmentExpression(BoundArrayAssignmentExpression *n)
 {
-    long long index = std::any_cast<long long>(EvaluateExpression(n->Index));
-    std::any value = EvaluateExpression(n->Expression);
+    long long index = EvaluateExpression(n->Index).AsInteger();
+    Value value = EvaluateExpression(n->Expression);
+    StoreElement(Lookup(n->Variable), index, value);
+    return value;
+}
 
-    if (n->type == TypeSymbol::String)
+Value Evaluator::LoadElement(const Value &target, long long index)
+{
+    if (target.IsString())
     {
-        std::string array = std::any_cast<std::string>(EvaluateExpression(n->Identifier));
-        std::string newValue = std::any_cast<std::string>(value);
-        if (index < 0 || index >= array.size())
+        const std::string &text = target.AsString();
+        if (index < 0 || static_cast<size_t>(index) >= text.size())
             throw std::runtime_error("Index out of bounds");
-        if (newValue.size() != 1)
-            throw std::runtime_error("Expected a character");
-        array[index] = newValue[0];
-        Assign(n->Variable, array);
-        return value;
+        return Value(std::string(1, text[index]));
     }
-    else
+
+    const ArrayObject &array = target.AsArray();
+    if (index < 0 || static_cast<size_t>(index) >= array.Size())
+        throw std::runtime_error("Index out of bounds");
+    return array.Get(index);
+}
+
+void Evaluator::StoreElement(Value &target, long long index, const Value &value)
+{
+    if (target.IsString())
     {
-        std::vector<std::any> array = std::any_cast<std::vector<std::any>>(EvaluateExpression(n->Identifier));
-        if (index < 0 || index >= array.size())
+        const std::string &character = value.AsString();
+        if (index < 0 || static_cast<size_t>(index) >= target.AsString().size())
             throw std::runtime_error("Index out of bounds");
-        array[index] = value;
-        Assign(n->Variable, array);
-        return value;
+        if (character.size() != 1)
+            throw std::runtime_error("Expected a character");
+        target.MutableString()[index] = character[0];
+        return;
     }
+
+    if (index < 0 || static_cast<size_t>(index) >= target.AsArray().Size())
+        throw std::runtime_error("Index out of bounds");
+    target.MutableArray().Set(index, value);
+}
+
+ValueKind Evaluator::GetElementKind(const TypeSymbol &arrayType)
+{
+    if (arrayType == TypeSymbol::ArrayInt)
+        return ValueKind::Integer;
+    if (arrayType == TypeSymbol::ArrayFloat)
+        return ValueKind::Float;
+    if (arrayType == TypeSymbol::ArrayBool)
+        return ValueKind::Boolean;
+    return ValueKind::None;
+}
+
+bool Evaluator::IsBuiltInFunction(const FunctionSymbol &function)
+{
+    return function.BuiltIn >= 0;
+}
+
+Value Evaluator::CallBuiltInFunction(const FunctionSymbol &function, const Value *arguments)
+{
+    return BuiltInFunctions::GetAll()[function.BuiltIn].Handler(arguments);
+}
+
+void Evaluator::Assign(const VariableSymbol &variable, Value value)
+{
+    Lookup(variable) = std::move(value);
 }
 
-void Evaluator::Assign(VariableSymbol variable, std::any value)
+Value &Evaluator::Lookup(const VariableSymbol &variable)
 {
     if (variable.GetKind() == SymbolKind::GlobalVariable)
-    {
-        _globals[variable] = value;
-    }
-    else
-    {
-        std::unordered_map<VariableSymbol, std::any> locals = _locals.top();
-        _locals.pop();
-        locals[variable] = value;
-        _locals.push(locals);
-    }
-}
\ No newline at end of file
+        return _globals[variable.Slot];
+    return _locals[_frameBase + variable.Slot];
+}
@@ -0,0 +1,273 @@
+#include "CodeAnalysis/Lowerer.h"
+#include "CodeAnalysis/Evaluator.h"
+
+template <typename Predicate>
+static bool Any(BoundExpression *node, Predicate predicate)
+{
+    if (predicate(node))
+        return true;
+
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::UnaryExpression:
+        return Any(((BoundUnaryExpression *)node)->Operand, predicate);
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        return Any(binary->Left, predicate) || Any(binary->Right, predicate);
+    }
+    case BoundNodeKind::ConversionExpression:
+        return Any(((BoundConversionExpression *)node)->Expression, predicate);
+    case BoundNodeKind::AssignmentExpression:
+        return Any(((BoundAssignmentExpression *)node)->Expression, predicate);
+    case BoundNodeKind::ArrayAccessExpression:
+    {
+        BoundArrayAccessExpression *access = (BoundArrayAccessExpression *)node;
+        return Any(access->Variable, predicate) || Any(access->Index, predicate);
+    }
+    case BoundNodeKind::ArrayAssignmentExpression:
+    {
+        BoundArrayAssignmentExpression *assignment = (BoundArrayAssignmentExpression *)node;
+        return Any(assignment->Index, predicate) || Any(assignment->Expression, predicate);
+    }
+    case BoundNodeKind::CallExpression:
+        for (auto &argument : ((BoundCallExpression *)node)->Arguments)
+        {
+            if (Any(argument, predicate))
+                return true;
+        }
+        return false;
+    case BoundNodeKind::ArrayInitializerExpression:
+        for (auto &element : ((BoundArrayInitializerExpression *)node)->Elements)
+        {
+            if (Any(element, predicate))
+                return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool CallLifter::IsUserCall(BoundExpression *node)
+{
+    return node->GetKind() == BoundNodeKind::CallExpression && !Evaluator::IsBuiltInFunction(((BoundCallExpression *)node)->Function);
+}
+
+bool CallLifter::ContainsCall(BoundExpression *node)
+{
+    return Any(node, IsUserCall);
+}
+
+// Rewrites a flat body so that user calls only appear as call sites. Calls
+// nested in expressions are moved into temporaries in evaluation order,
+// together with whatever had to be evaluated before them.
+BoundBlockStatement *CallLifter::Lift(Arena *arena, BoundBlockStatement *body)
+{
+    CallLifter lifter(arena);
+    lifter._localCount = body->LocalCount;
+    bool changed = false;
+
+    for (auto &statement : body->Statements)
+    {
+        BoundStatement *result = statement;
+        switch (statement->GetKind())
+        {
+        case BoundNodeKind::VariableDeclaration:
+        {
+            BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)statement;
+            if (IsUserCall(declaration->Initializer))
+            {
+                BoundCallExpression *call = lifter.LiftArguments((BoundCallExpression *)declaration->Initializer);
+                if (call != declaration->Initializer)
+                    result = arena->New<BoundVariableDeclaration>(declaration->Variable, call);
+            }
+            else if (ContainsCall(declaration->Initializer))
+                result = arena->New<BoundVariableDeclaration>(declaration->Variable, lifter.LiftExpression(declaration->Initializer));
+            break;
+        }
+        case BoundNodeKind::ExpressionStatement:
+        {
+            BoundExpression *expression = ((BoundExpressionStatement *)statement)->Expression;
+            if (IsUserCall(expression))
+            {
+                BoundCallExpression *call = lifter.LiftArguments((BoundCallExpression *)expression);
+                if (call != expression)
+                    result = arena->New<BoundExpressionStatement>(call);
+            }
+            else if (expression->GetKind() == BoundNodeKind::AssignmentExpression &&
+                     IsUserCall(((BoundAssignmentExpression *)expression)->Expression))
+            {
+                BoundAssignmentExpression *assignment = (BoundAssignmentExpression *)expression;
+                BoundCallExpression *call = lifter.LiftArguments((BoundCallExpression *)assignment->Expression);
+                if (call != assignment->Expression)
+                    result = arena->New<BoundExpressionStatement>(arena->New<BoundAssignmentExpression>(assignment->Variable, call));
+            }
+            else if (ContainsCall(expression))
+                result = arena->New<BoundExpressionStatement>(lifter.LiftExpression(expression));
+            break;
+        }
+        case BoundNodeKind::ReturnStatement:
+        {
+            BoundExpression *expression = ((BoundReturnStatement *)statement)->Expression;
+            if (expression == nullptr)
+                break;
+            if (IsUserCall(expression))
+            {
+                BoundCallExpression *call = lifter.LiftArguments((BoundCallExpression *)expression);
+                if (call != expression)
+                    result = arena->New<BoundReturnStatement>(call);
+            }
+            else if (ContainsCall(expression))
+                result = arena->New<BoundReturnStatement>(lifter.LiftExpression(expression));
+            break;
+        }
+        case BoundNodeKind::ConditionalGotoStatement:
+        {
+            BoundConditionalGotoStatement *conditionalGoto = (BoundConditionalGotoStatement *)statement;
+            if (ContainsCall(conditionalGoto->Condition))
+                result = arena->New<BoundConditionalGotoStatement>(conditionalGoto->Label, lifter.LiftExpression(conditionalGoto->Condition), conditionalGoto->JumpIfTrue);
+            break;
+        }
+        default:
+            break;
+        }
+
+        changed |= result != statement;
+        lifter._statements.push_back(result);
+    }
+
+    if (!changed)
+        return body;
+
+    BoundBlockStatement *block = arena->New<BoundBlockStatement>(lifter._statements);
+    block->LocalCount = lifter._localCount;
+    Lowerer::ResolveLabels(block);
+    return block;
+}
+
+BoundExpression *CallLifter::Spill(BoundExpression *node)
+{
+    LocalVariableSymbol temporary("callResult", false, node->type);
+    temporary.Slot = _localCount++;
+    _statements.push_back(_arena->New<BoundVariableDeclaration>(temporary, node));
+
+    BoundExpression *result = _arena->New<BoundVariableExpression>(temporary);
+    result->type = node->type;
+    return result;
+}
+
+// Operands evaluated before the last one that contains a call are stored
+// first, unless they are literals or locals that nothing after them assigns.
+std::vector<BoundExpression *> CallLifter::LiftOperands(const std::vector<BoundExpression *> &operands)
+{
+    int last = -1;
+    for (int i = 0; i < static_cast<int>(operands.size()); i++)
+    {
+        if (ContainsCall(operands[i]))
+            last = i;
+    }
+
+    std::vector<BoundExpression *> result = operands;
+    for (int i = 0; i < last; i++)
+    {
+        BoundExpression *operand = operands[i];
+        if (operand->GetKind() == BoundNodeKind::LiteralExpression)
+            continue;
+
+        if (operand->GetKind() == BoundNodeKind::VariableExpression &&
+            ((BoundVariableExpression *)operand)->Variable.GetKind() == SymbolKind::LocalVariable)
+        {
+            bool assigned = false;
+            for (int j = i + 1; j <= last && !assigned; j++)
+            {
+                assigned = Any(operands[j], [](BoundExpression *node)
+                               { return node->GetKind() == BoundNodeKind::AssignmentExpression; });
+            }
+            if (!assigned)
+                continue;
+        }
+        result[i] = Spill(LiftExpression(operand));
+    }
+    if (last >= 0)
+        result[last] = LiftExpression(operands[last]);
+    return result;
+}
+
+BoundCallExpression *CallLifter::LiftArguments(BoundCallExpression *node)
+{
+    std::vector<BoundExpression *> arguments = LiftOperands(node->Arguments);
+    if (arguments == node->Arguments)
+        return node;
+    return _arena->New<BoundCallExpression>(node->Function, arguments);
+}
+
+BoundExpression *CallLifter::LiftExpression(BoundExpression *node)
+{
+    if (!ContainsCall(node))
+        return node;
+
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::CallExpression:
+    {
+        BoundCallExpression *call = LiftArguments((BoundCallExpression *)node);
+        return IsUserCall(call) ? Spill(call) : call;
+    }
+    case BoundNodeKind::UnaryExpression:
+    {
+        BoundUnaryExpression *unary = (BoundUnaryExpression *)node;
+        return _arena->New<BoundUnaryExpression>(unary->Op, LiftExpression(unary->Operand));
+    }
+    case BoundNodeKind::ConversionExpression:
+    {
+        BoundConversionExpression *conversion = (BoundConversionExpression *)node;
+        return _arena->New<BoundConversionExpression>(conversion->type, LiftExpression(conversion->Expression));
+    }
+    case BoundNodeKind::AssignmentExpression:
+    {
+        BoundAssignmentExpression *assignment = (BoundAssignmentExpression *)node;
+        return _arena->New<BoundAssignmentExpression>(assignment->Variable, LiftExpression(assignment->Expression));
+    }
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        bool logicalAnd = binary->Op->Kind == BoundBinaryOperatorKind::LogicalAnd;
+        bool logicalOr = binary->Op->Kind == BoundBinaryOperatorKind::LogicalOr;
+        if ((logicalAnd || logicalOr) && ContainsCall(binary->Right))
+        {
+            BoundExpression *result = Spill(LiftExpression(binary->Left));
+            BoundLabel end("CallEnd" + std::to_string(++_labelCount));
+            _statements.push_back(_arena->New<BoundConditionalGotoStatement>(end, result, logicalOr));
+            BoundVariableExpression *temporary = (BoundVariableExpression *)result;
+            _statements.push_back(_arena->New<BoundExpressionStatement>(_arena->New<BoundAssignmentExpression>(temporary->Variable, LiftExpression(binary->Right))));
+            _statements.push_back(_arena->New<BoundLabelStatement>(end));
+            return result;
+        }
+
+        std::vector<BoundExpression *> operands = LiftOperands({binary->Left, binary->Right});
+        return _arena->New<BoundBinaryExpression>(operands[0], binary->Op, operands[1]);
+    }
+    case BoundNodeKind::ArrayAccessExpression:
+    {
+        BoundArrayAccessExpression *access = (BoundArrayAccessExpression *)node;
+        std::vector<BoundExpression *> operands = LiftOperands({access->Index, access->Variable});
+        BoundExpression *result = _arena->New<BoundArrayAccessExpression>(operands[1], operands[0]);
+        result->type = node->type;
+        return result;
+    }
+    case BoundNodeKind::ArrayAssignmentExpression:
+    {
+        BoundArrayAssignmentExpression *assignment = (BoundArrayAssignmentExpression *)node;
+        std::vector<BoundExpression *> operands = LiftOperands({assignment->Index, assignment->Expression});
+        return _arena->New<BoundArrayAssignmentExpression>(assignment->Identifier, operands[0], operands[1], assignment->Variable);
+    }
+    case BoundNodeKind::ArrayInitializerExpression:
+    {
+        BoundArrayInitializerExpression *initializer = (BoundArrayInitializerExpression *)node;
+        return _arena->New<BoundArrayInitializerExpression>(LiftOperands(initializer->Elements), initializer->type);
+    }
+    default:
+        return node;
+    }
+}
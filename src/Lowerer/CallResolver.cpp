@@ -0,0 +1,44 @@
+#include "CodeAnalysis/Lowerer.h"
+
+// Points every call to a user function at the callee's body, so running a
+// call does not look the function up. Builtin calls keep a null body. Has to
+// run again whenever a pass replaces function bodies.
+//
+// Calls can be shared with the global scope and other programs, so each call
+// is copied into the program first. The copies get their bodies once every
+// function has been rewritten, since a body can call itself.
+void CallResolver::Resolve(BoundProgram *program)
+{
+    CallResolver resolver(program);
+    for (auto &[function, body] : program->Functions)
+        body = resolver.RewriteBody(body);
+    program->statement = resolver.RewriteBody(program->statement);
+
+    for (BoundCallExpression *call : resolver._calls)
+    {
+        auto it = program->Functions.find(call->Function);
+        call->Body = it == program->Functions.end() ? nullptr : it->second;
+    }
+}
+
+BoundBlockStatement *CallResolver::RewriteBody(BoundBlockStatement *body)
+{
+    BoundBlockStatement *result = (BoundBlockStatement *)RewriteStatement(body);
+    if (result == body)
+        return body;
+
+    result->LocalCount = body->LocalCount;
+    Lowerer::ResolveLabels(result);
+    return result;
+}
+
+BoundExpression *CallResolver::RewriteCallExpression(BoundCallExpression *node)
+{
+    std::vector<BoundExpression *> arguments;
+    for (BoundExpression *argument : node->Arguments)
+        arguments.push_back(RewriteExpression(argument));
+
+    BoundCallExpression *call = _arena->New<BoundCallExpression>(node->Function, arguments);
+    _calls.push_back(call);
+    return call;
+}
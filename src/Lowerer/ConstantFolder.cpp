@@ -0,0 +1,138 @@
+#include "CodeAnalysis/Lowerer.h"
+#include "CodeAnalysis/Evaluator.h"
+#include <cmath>
+#include <cstdio>
+
+static bool TryGetLiteralValue(BoundExpression *node, Value &value)
+{
+    if (node->GetKind() != BoundNodeKind::LiteralExpression)
+        return false;
+
+    BoundLiteralExpression *literal = (BoundLiteralExpression *)node;
+    if (literal->type != TypeSymbol::Integer && literal->type != TypeSymbol::Float &&
+        literal->type != TypeSymbol::Boolean && literal->type != TypeSymbol::String)
+        return false;
+
+    value = ConstantPool::Decode(literal);
+    return true;
+}
+
+// Returns nullptr when the value cannot be written back as a literal of the
+// given type without changing what the evaluator or the emitter would see.
+static BoundLiteralExpression *MakeLiteral(Arena *arena, const Value &value, const TypeSymbol &type)
+{
+    if (type == TypeSymbol::Integer && value.IsInteger())
+        return arena->New<BoundLiteralExpression>(std::to_string(value.AsInteger()), type);
+    if (type == TypeSymbol::Boolean && value.IsBoolean())
+        return arena->New<BoundLiteralExpression>(value.AsBoolean() ? "true" : "false", type);
+    if (type == TypeSymbol::String && value.IsString())
+        return arena->New<BoundLiteralExpression>(value.AsString(), type);
+    if (type == TypeSymbol::Float && value.IsFloat() && std::isfinite(value.AsFloat()))
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value.AsFloat());
+        std::string text = buffer;
+        if (text.find_first_of(".e") == std::string::npos)
+            text += ".0";
+        return arena->New<BoundLiteralExpression>(text, type);
+    }
+    return nullptr;
+}
+
+BoundStatement *ConstantFolder::Fold(Arena *arena, BoundStatement *node)
+{
+    ConstantFolder folder(arena);
+    return folder.RewriteStatement(node);
+}
+
+BoundStatement *ConstantFolder::RewriteVariableDeclaration(BoundVariableDeclaration *node)
+{
+    BoundStatement *result = BoundTreeRewriter::RewriteVariableDeclaration(node);
+    BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)result;
+
+    if (declaration->Variable.IsReadOnly && declaration->Variable.Slot >= 0 &&
+        declaration->Initializer->GetKind() == BoundNodeKind::LiteralExpression)
+    {
+        BoundLiteralExpression *literal = (BoundLiteralExpression *)declaration->Initializer;
+        if (literal->type == declaration->Variable.Type)
+            _constants[{declaration->Variable.GetKind(), declaration->Variable.Slot}] = literal;
+    }
+    return result;
+}
+
+BoundStatement *ConstantFolder::RewriteConditionalGotoStatement(BoundConditionalGotoStatement *node)
+{
+    BoundStatement *result = BoundTreeRewriter::RewriteConditionalGotoStatement(node);
+    BoundConditionalGotoStatement *conditionalGoto = (BoundConditionalGotoStatement *)result;
+
+    Value condition;
+    if (!TryGetLiteralValue(conditionalGoto->Condition, condition) || !condition.IsBoolean())
+        return result;
+
+    if (condition.AsBoolean() == conditionalGoto->JumpIfTrue)
+        return _arena->New<BoundGotoStatement>(conditionalGoto->Label);
+    return _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>());
+}
+
+BoundExpression *ConstantFolder::RewriteVariableExpression(BoundVariableExpression *node)
+{
+    auto it = _constants.find({node->Variable.GetKind(), node->Variable.Slot});
+    if (it == _constants.end())
+        return node;
+    return _arena->New<BoundLiteralExpression>(it->second->Value, it->second->type);
+}
+
+BoundExpression *ConstantFolder::RewriteUnaryExpression(BoundUnaryExpression *node)
+{
+    BoundExpression *result = BoundTreeRewriter::RewriteUnaryExpression(node);
+    BoundUnaryExpression *unary = (BoundUnaryExpression *)result;
+
+    Value operand;
+    if (!TryGetLiteralValue(unary->Operand, operand))
+        return result;
+
+    BoundLiteralExpression *literal = MakeLiteral(_arena, unary->Op->Handler(operand), unary->Op->ResultType);
+    return literal == nullptr ? result : literal;
+}
+
+BoundExpression *ConstantFolder::RewriteBinaryExpression(BoundBinaryExpression *node)
+{
+    BoundExpression *result = BoundTreeRewriter::RewriteBinaryExpression(node);
+    BoundBinaryExpression *binary = (BoundBinaryExpression *)result;
+
+    Value left;
+    Value right;
+    if (!TryGetLiteralValue(binary->Left, left) || !TryGetLiteralValue(binary->Right, right))
+        return result;
+
+    if (binary->Op->Kind == BoundBinaryOperatorKind::Division && right.IsInteger() && right.AsInteger() == 0)
+        return result;
+
+    BoundLiteralExpression *literal = MakeLiteral(_arena, binary->Op->Handler(left, right), binary->Op->ResultType);
+    return literal == nullptr ? result : literal;
+}
+
+BoundExpression *ConstantFolder::RewriteConversionExpression(BoundConversionExpression *node)
+{
+    BoundExpression *result = BoundTreeRewriter::RewriteConversionExpression(node);
+    BoundConversionExpression *conversion = (BoundConversionExpression *)result;
+
+    Value value;
+    if (!TryGetLiteralValue(conversion->Expression, value))
+        return result;
+
+    // bool(string) tests for an empty string in cyi but parses the text in
+    // cyc, so it is left for run time.
+    if (conversion->type == TypeSymbol::Boolean && value.IsString())
+        return result;
+
+    try
+    {
+        BoundLiteralExpression *literal = MakeLiteral(_arena, Evaluator::ApplyConversion(conversion->type, value), conversion->type);
+        return literal == nullptr ? result : literal;
+    }
+    catch (const std::exception &)
+    {
+        return result;
+    }
+}
@@ -0,0 +1,52 @@
+#include "CodeAnalysis/Lowerer.h"
+
+void ConstantPool::Build(BoundProgram *program)
+{
+    ConstantPool pool(&program->Nodes);
+    for (auto &[function, body] : program->Functions)
+        body = pool.RewriteBody(body);
+    program->statement = pool.RewriteBody(program->statement);
+    program->Constants = std::move(pool._constants);
+}
+
+// Literals can be shared with the global scope and other programs, so every
+// literal is copied into the program before it gets its constant index.
+BoundBlockStatement *ConstantPool::RewriteBody(BoundBlockStatement *body)
+{
+    BoundBlockStatement *result = (BoundBlockStatement *)RewriteStatement(body);
+    if (result == body)
+        return body;
+
+    result->LocalCount = body->LocalCount;
+    Lowerer::ResolveLabels(result);
+    return result;
+}
+
+Value ConstantPool::Decode(BoundLiteralExpression *node)
+{
+    if (node->type == TypeSymbol::Boolean)
+        return Value(node->Value == "true");
+    if (node->type == TypeSymbol::String)
+        return Value(node->Value);
+    if (node->type == TypeSymbol::Float)
+        return Value(std::stod(node->Value));
+
+    return Value(std::stoll(node->Value));
+}
+
+BoundExpression *ConstantPool::RewriteLiteralExpression(BoundLiteralExpression *node)
+{
+    BoundLiteralExpression *literal = _arena->New<BoundLiteralExpression>(node->Value, node->type);
+    std::string key = std::to_string(node->type.Id) + ":" + node->Value;
+    auto it = _indices.find(key);
+    if (it != _indices.end())
+    {
+        literal->ConstantIndex = it->second;
+        return literal;
+    }
+
+    literal->ConstantIndex = _constants.size();
+    _constants.push_back(Decode(node));
+    _indices[key] = literal->ConstantIndex;
+    return literal;
+}
@@ -0,0 +1,162 @@
+#include "CodeAnalysis/Lowerer.h"
+#include "CodeAnalysis/ControlFlowGraph.h"
+
+static bool HasSideEffects(BoundExpression *node)
+{
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::LiteralExpression:
+    case BoundNodeKind::VariableExpression:
+        return false;
+    case BoundNodeKind::UnaryExpression:
+        return HasSideEffects(((BoundUnaryExpression *)node)->Operand);
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        if (binary->Op->Kind == BoundBinaryOperatorKind::Division && binary->Right->GetKind() != BoundNodeKind::LiteralExpression)
+            return true;
+        return HasSideEffects(binary->Left) || HasSideEffects(binary->Right);
+    }
+    case BoundNodeKind::ConversionExpression:
+    {
+        BoundConversionExpression *conversion = (BoundConversionExpression *)node;
+        if (conversion->type != TypeSymbol::String && conversion->Expression->type == TypeSymbol::String)
+            return true;
+        return HasSideEffects(conversion->Expression);
+    }
+    case BoundNodeKind::ArrayInitializerExpression:
+        for (auto &element : ((BoundArrayInitializerExpression *)node)->Elements)
+        {
+            if (HasSideEffects(element))
+                return true;
+        }
+        return false;
+    default:
+        return true;
+    }
+}
+
+static BoundLabel *GetJumpLabel(BoundStatement *statement)
+{
+    if (statement->GetKind() == BoundNodeKind::GotoStatement)
+        return &((BoundGotoStatement *)statement)->Label;
+    if (statement->GetKind() == BoundNodeKind::ConditionalGotoStatement)
+        return &((BoundConditionalGotoStatement *)statement)->Label;
+    if (statement->GetKind() == BoundNodeKind::CountedGotoStatement)
+        return &((BoundCountedGotoStatement *)statement)->Label;
+    return nullptr;
+}
+
+// Works on both flat and nested bodies: the analysis runs on a flattened
+// view, which shares its statements with the body being rewritten.
+BoundBlockStatement *DeadCodeEliminator::Eliminate(Arena *arena, BoundBlockStatement *body)
+{
+    BoundBlockStatement *flat = Lowerer::Flatten(arena, body);
+    ControlFlowGraph *graph = ControlFlowGraph::Create(flat);
+
+    std::unordered_set<BoundStatement *> reachable;
+    for (auto &block : graph->Blocks)
+        reachable.insert(block->Statements.begin(), block->Statements.end());
+    delete graph;
+
+    std::vector<BoundStatement *> statements;
+    for (auto &statement : flat->Statements)
+    {
+        if (reachable.count(statement))
+            statements.push_back(statement);
+    }
+
+    // A goto that only skips over labels falls through to the same place.
+    std::unordered_set<BoundStatement *> removed;
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        if (statements[i]->GetKind() != BoundNodeKind::GotoStatement)
+            continue;
+
+        BoundLabel &label = ((BoundGotoStatement *)statements[i])->Label;
+        for (size_t j = i + 1; j < statements.size() && statements[j]->GetKind() == BoundNodeKind::LabelStatement; j++)
+        {
+            if (((BoundLabelStatement *)statements[j])->Label == label)
+            {
+                removed.insert(statements[i]);
+                break;
+            }
+        }
+    }
+
+    std::unordered_set<BoundLabel> usedLabels;
+    for (auto &statement : statements)
+    {
+        BoundLabel *label = GetJumpLabel(statement);
+        if (label != nullptr && !removed.count(statement))
+            usedLabels.insert(*label);
+    }
+
+    DeadCodeEliminator eliminator(arena);
+    for (auto &statement : statements)
+    {
+        if (removed.count(statement))
+            continue;
+        if (statement->GetKind() == BoundNodeKind::LabelStatement && !usedLabels.count(((BoundLabelStatement *)statement)->Label))
+            continue;
+        eliminator._live.insert(statement);
+    }
+
+    eliminator._collecting = true;
+    for (auto &statement : eliminator._live)
+        eliminator.RewriteStatement(statement);
+    eliminator._collecting = false;
+
+    BoundBlockStatement *result = (BoundBlockStatement *)eliminator.RewriteStatement(body);
+    result->LocalCount = body->LocalCount;
+    return result;
+}
+
+BoundStatement *DeadCodeEliminator::RewriteStatement(BoundStatement *node)
+{
+    if (_collecting || node->GetKind() == BoundNodeKind::BlockStatement)
+        return BoundTreeRewriter::RewriteStatement(node);
+
+    if (!_live.count(node))
+        return _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>());
+
+    if (node->GetKind() == BoundNodeKind::VariableDeclaration)
+    {
+        BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)node;
+        if (IsDeadStore(declaration->Variable))
+        {
+            if (!HasSideEffects(declaration->Initializer))
+                return _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>());
+            return _arena->New<BoundExpressionStatement>(declaration->Initializer);
+        }
+    }
+    else if (node->GetKind() == BoundNodeKind::ExpressionStatement)
+    {
+        BoundExpression *expression = ((BoundExpressionStatement *)node)->Expression;
+        if (expression->GetKind() == BoundNodeKind::AssignmentExpression)
+        {
+            BoundAssignmentExpression *assignment = (BoundAssignmentExpression *)expression;
+            if (IsDeadStore(assignment->Variable))
+            {
+                if (!HasSideEffects(assignment->Expression))
+                    return _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>());
+                return _arena->New<BoundExpressionStatement>(assignment->Expression);
+            }
+        }
+    }
+    return node;
+}
+
+BoundExpression *DeadCodeEliminator::RewriteVariableExpression(BoundVariableExpression *node)
+{
+    if (_collecting && node->Variable.GetKind() != SymbolKind::GlobalVariable)
+        _readLocals.insert(node->Variable.Slot);
+    return node;
+}
+
+// Globals stay visible to other functions and to later REPL submissions,
+// so only locals can be dead.
+bool DeadCodeEliminator::IsDeadStore(const VariableSymbol &variable) const
+{
+    return variable.GetKind() != SymbolKind::GlobalVariable && !_readLocals.count(variable.Slot);
+}
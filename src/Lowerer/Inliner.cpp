@@ -0,0 +1,382 @@
+#include "CodeAnalysis/Lowerer.h"
+
+class CallCollector : public BoundTreeRewriter
+{
+public:
+    std::vector<FunctionSymbol> Callees;
+
+    CallCollector(Arena *arena) : BoundTreeRewriter(arena) {}
+
+protected:
+    BoundExpression *RewriteCallExpression(BoundCallExpression *node) override
+    {
+        Callees.push_back(node->Function);
+        return BoundTreeRewriter::RewriteCallExpression(node);
+    }
+};
+
+// Copies a callee body into a caller. Locals and parameters move to fresh
+// caller slots, labels get fresh ids, and every return becomes a jump to
+// the end of the inlined body. Statements are always copied so that no
+// two call sites share a node.
+class InlineCloner : public BoundTreeRewriter
+{
+public:
+    InlineCloner(Arena *arena, const std::string &prefix, int slotBase, const VariableSymbol *result, BoundLabel end)
+        : BoundTreeRewriter(arena), _prefix(prefix), _slotBase(slotBase), _result(result), _end(end) {}
+
+    VariableSymbol MapVariable(const VariableSymbol &variable)
+    {
+        if (variable.GetKind() == SymbolKind::GlobalVariable)
+            return variable;
+
+        auto it = _variables.find(variable);
+        if (it != _variables.end())
+            return it->second;
+
+        VariableSymbol local(SymbolKind::LocalVariable, _prefix + variable.Name, variable.IsReadOnly, variable.Type);
+        local.Slot = _slotBase + variable.Slot;
+        _variables.emplace(variable, local);
+        return local;
+    }
+
+protected:
+    BoundStatement *RewriteVariableDeclaration(BoundVariableDeclaration *node) override
+    {
+        return _arena->New<BoundVariableDeclaration>(MapVariable(node->Variable), RewriteExpression(node->Initializer));
+    }
+
+    BoundStatement *RewriteExpressionStatement(BoundExpressionStatement *node) override
+    {
+        return _arena->New<BoundExpressionStatement>(RewriteExpression(node->Expression));
+    }
+
+    BoundStatement *RewriteLabelStatement(BoundLabelStatement *node) override
+    {
+        return _arena->New<BoundLabelStatement>(MapLabel(node->Label));
+    }
+
+    BoundStatement *RewriteGotoStatement(BoundGotoStatement *node) override
+    {
+        return _arena->New<BoundGotoStatement>(MapLabel(node->Label));
+    }
+
+    BoundStatement *RewriteConditionalGotoStatement(BoundConditionalGotoStatement *node) override
+    {
+        return _arena->New<BoundConditionalGotoStatement>(MapLabel(node->Label), RewriteExpression(node->Condition), node->JumpIfTrue);
+    }
+
+    BoundStatement *RewriteCountedGotoStatement(BoundCountedGotoStatement *node) override
+    {
+        return _arena->New<BoundCountedGotoStatement>(MapLabel(node->Label), RewriteExpression(node->Variable), RewriteExpression(node->UpperBound));
+    }
+
+    BoundStatement *RewriteReturnStatement(BoundReturnStatement *node) override
+    {
+        std::vector<BoundStatement *> statements;
+        if (node->Expression != nullptr)
+        {
+            BoundExpression *expression = RewriteExpression(node->Expression);
+            if (_result != nullptr)
+                expression = _arena->New<BoundAssignmentExpression>(*_result, expression);
+            statements.push_back(_arena->New<BoundExpressionStatement>(expression));
+        }
+        statements.push_back(_arena->New<BoundGotoStatement>(_end));
+        return _arena->New<BoundBlockStatement>(statements);
+    }
+
+    BoundExpression *RewriteVariableExpression(BoundVariableExpression *node) override
+    {
+        if (node->Variable.GetKind() == SymbolKind::GlobalVariable)
+            return node;
+
+        BoundExpression *result = _arena->New<BoundVariableExpression>(MapVariable(node->Variable));
+        result->type = node->type;
+        return result;
+    }
+
+    BoundExpression *RewriteAssignmentExpression(BoundAssignmentExpression *node) override
+    {
+        return _arena->New<BoundAssignmentExpression>(MapVariable(node->Variable), RewriteExpression(node->Expression));
+    }
+
+    BoundExpression *RewriteArrayAssignmentExpression(BoundArrayAssignmentExpression *node) override
+    {
+        BoundExpression *identifier = RewriteExpression(node->Identifier);
+        BoundExpression *index = RewriteExpression(node->Index);
+        BoundExpression *expression = RewriteExpression(node->Expression);
+        return _arena->New<BoundArrayAssignmentExpression>(identifier, index, expression, MapVariable(node->Variable));
+    }
+
+private:
+    std::string _prefix;
+    int _slotBase;
+    const VariableSymbol *_result;
+    BoundLabel _end;
+    std::unordered_map<VariableSymbol, VariableSymbol> _variables;
+    std::unordered_map<BoundLabel, BoundLabel> _labels;
+
+    BoundLabel MapLabel(const BoundLabel &label)
+    {
+        auto it = _labels.find(label);
+        if (it != _labels.end())
+            return it->second;
+
+        BoundLabel copy(_prefix + label.Name);
+        _labels.emplace(label, copy);
+        return copy;
+    }
+};
+
+void Inliner::Inline(BoundProgram *program)
+{
+    if (!program->Diagnostics.empty())
+        return;
+
+    Inliner inliner(program);
+    for (auto &[function, body] : program->Functions)
+    {
+        CallCollector collector(&program->Nodes);
+        collector.RewriteStatement(body);
+        inliner._callees[function] = std::move(collector.Callees);
+    }
+
+    for (auto &[function, body] : program->Functions)
+    {
+        std::unordered_set<FunctionSymbol> seen;
+        if (inliner.Reaches(function, function, seen))
+            inliner._recursive.insert(function);
+    }
+
+    for (auto &[function, body] : program->Functions)
+        inliner.Visit(function);
+    program->statement = inliner.InlineCalls(program->statement);
+}
+
+bool Inliner::Reaches(const FunctionSymbol &from, const FunctionSymbol &to, std::unordered_set<FunctionSymbol> &seen)
+{
+    for (auto &callee : _callees[from])
+    {
+        if (callee == to)
+            return true;
+        if (seen.insert(callee).second && Reaches(callee, to, seen))
+            return true;
+    }
+    return false;
+}
+
+// Callees are processed first, so a body that gets inlined already has its
+// own small callees inlined into it.
+void Inliner::Visit(const FunctionSymbol &function)
+{
+    if (!_visited.insert(function).second)
+        return;
+
+    for (auto &callee : _callees[function])
+    {
+        if (_program->Functions.count(callee))
+            Visit(callee);
+    }
+
+    BoundBlockStatement *&body = _program->Functions[function];
+    body = InlineCalls(body);
+}
+
+BoundBlockStatement *Inliner::GetInlinableBody(BoundExpression *node)
+{
+    if (node == nullptr || node->GetKind() != BoundNodeKind::CallExpression)
+        return nullptr;
+
+    const FunctionSymbol &function = ((BoundCallExpression *)node)->Function;
+    auto it = _program->Functions.find(function);
+    if (it == _program->Functions.end() || _recursive.count(function))
+        return nullptr;
+
+    int size = 0;
+    for (auto &statement : it->second->Statements)
+    {
+        if (statement->GetKind() != BoundNodeKind::LabelStatement)
+            size++;
+    }
+    return size <= StatementBudget ? it->second : nullptr;
+}
+
+// Calls nested inside an expression are moved in front of the statement,
+// in evaluation order, as long as nothing evaluated before them could be
+// affected by the callee. Once a global read, an assignment, a call that
+// stays or the right side of && or || is passed, the rest is left alone.
+BoundExpression *Inliner::Hoist(BoundExpression *node, bool &blocked, std::vector<BoundStatement *> &statements, int &localCount)
+{
+    if (blocked)
+        return node;
+
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::LiteralExpression:
+        return node;
+    case BoundNodeKind::VariableExpression:
+        if (((BoundVariableExpression *)node)->Variable.GetKind() == SymbolKind::GlobalVariable)
+            blocked = true;
+        return node;
+    case BoundNodeKind::UnaryExpression:
+    {
+        BoundUnaryExpression *unary = (BoundUnaryExpression *)node;
+        BoundExpression *operand = Hoist(unary->Operand, blocked, statements, localCount);
+        if (operand == unary->Operand)
+            return node;
+        return _arena->New<BoundUnaryExpression>(unary->Op, operand);
+    }
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        BoundExpression *left = Hoist(binary->Left, blocked, statements, localCount);
+        BoundExpression *right = binary->Right;
+        if (binary->Op->Kind == BoundBinaryOperatorKind::LogicalAnd || binary->Op->Kind == BoundBinaryOperatorKind::LogicalOr)
+            blocked = true;
+        else
+            right = Hoist(binary->Right, blocked, statements, localCount);
+        if (left == binary->Left && right == binary->Right)
+            return node;
+        return _arena->New<BoundBinaryExpression>(left, binary->Op, right);
+    }
+    case BoundNodeKind::ConversionExpression:
+    {
+        BoundConversionExpression *conversion = (BoundConversionExpression *)node;
+        BoundExpression *expression = Hoist(conversion->Expression, blocked, statements, localCount);
+        if (expression == conversion->Expression)
+            return node;
+        return _arena->New<BoundConversionExpression>(conversion->type, expression);
+    }
+    case BoundNodeKind::CallExpression:
+    {
+        BoundCallExpression *call = (BoundCallExpression *)node;
+        std::vector<BoundExpression *> arguments;
+        bool changed = false;
+        for (auto &argument : call->Arguments)
+        {
+            arguments.push_back(Hoist(argument, blocked, statements, localCount));
+            changed |= arguments.back() != argument;
+        }
+        if (changed)
+            call = _arena->New<BoundCallExpression>(call->Function, arguments);
+
+        if (!blocked && GetInlinableBody(call) != nullptr)
+            return Expand(call, true, statements, localCount);
+
+        blocked = true;
+        return call;
+    }
+    default:
+        blocked = true;
+        return node;
+    }
+}
+
+BoundBlockStatement *Inliner::InlineCalls(BoundBlockStatement *body)
+{
+    std::vector<BoundStatement *> statements;
+    int localCount = body->LocalCount;
+    int expanded = _siteCount;
+
+    for (auto &statement : body->Statements)
+    {
+        bool blocked = false;
+        switch (statement->GetKind())
+        {
+        case BoundNodeKind::ExpressionStatement:
+        {
+            BoundExpression *expression = ((BoundExpressionStatement *)statement)->Expression;
+            if (GetInlinableBody(expression) != nullptr)
+            {
+                BoundCallExpression *call = (BoundCallExpression *)expression;
+                std::vector<BoundExpression *> arguments;
+                for (auto &argument : call->Arguments)
+                    arguments.push_back(Hoist(argument, blocked, statements, localCount));
+                Expand(_arena->New<BoundCallExpression>(call->Function, arguments), false, statements, localCount);
+                continue;
+            }
+
+            if (expression->GetKind() == BoundNodeKind::AssignmentExpression)
+            {
+                BoundAssignmentExpression *assignment = (BoundAssignmentExpression *)expression;
+                BoundExpression *value = Hoist(assignment->Expression, blocked, statements, localCount);
+                if (value != assignment->Expression)
+                    statement = _arena->New<BoundExpressionStatement>(_arena->New<BoundAssignmentExpression>(assignment->Variable, value));
+                break;
+            }
+
+            BoundExpression *result = Hoist(expression, blocked, statements, localCount);
+            if (result != expression)
+                statement = _arena->New<BoundExpressionStatement>(result);
+            break;
+        }
+        case BoundNodeKind::VariableDeclaration:
+        {
+            BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)statement;
+            BoundExpression *initializer = Hoist(declaration->Initializer, blocked, statements, localCount);
+            if (initializer != declaration->Initializer)
+                statement = _arena->New<BoundVariableDeclaration>(declaration->Variable, initializer);
+            break;
+        }
+        case BoundNodeKind::ReturnStatement:
+        {
+            BoundReturnStatement *returnStatement = (BoundReturnStatement *)statement;
+            if (returnStatement->Expression == nullptr)
+                break;
+            BoundExpression *expression = Hoist(returnStatement->Expression, blocked, statements, localCount);
+            if (expression != returnStatement->Expression)
+                statement = _arena->New<BoundReturnStatement>(expression);
+            break;
+        }
+        case BoundNodeKind::ConditionalGotoStatement:
+        {
+            BoundConditionalGotoStatement *conditionalGoto = (BoundConditionalGotoStatement *)statement;
+            BoundExpression *condition = Hoist(conditionalGoto->Condition, blocked, statements, localCount);
+            if (condition != conditionalGoto->Condition)
+                statement = _arena->New<BoundConditionalGotoStatement>(conditionalGoto->Label, condition, conditionalGoto->JumpIfTrue);
+            break;
+        }
+        default:
+            break;
+        }
+        statements.push_back(statement);
+    }
+
+    if (_siteCount == expanded)
+        return body;
+
+    BoundBlockStatement *block = Lowerer::Flatten(_arena, DeadCodeEliminator::Eliminate(_arena, _arena->New<BoundBlockStatement>(statements)));
+    block->LocalCount = localCount;
+    Lowerer::ResolveLabels(block);
+    return block;
+}
+
+BoundExpression *Inliner::Expand(BoundCallExpression *call, bool needsResult, std::vector<BoundStatement *> &statements, int &localCount)
+{
+    const FunctionSymbol &function = call->Function;
+    BoundBlockStatement *body = _program->Functions[function];
+    std::string prefix = function.Name + std::to_string(++_siteCount) + ".";
+
+    int slotBase = localCount;
+    localCount += body->LocalCount;
+
+    VariableSymbol result(SymbolKind::LocalVariable, prefix + "result", false, function.Type);
+    if (needsResult)
+        result.Slot = localCount++;
+
+    BoundLabel end(prefix + "end");
+    InlineCloner cloner(_arena, prefix, slotBase, needsResult ? &result : nullptr, end);
+
+    for (size_t i = 0; i < call->Arguments.size(); i++)
+    {
+        VariableSymbol parameter = function.Parameters[i];
+        parameter.Slot = i;
+        statements.push_back(_arena->New<BoundVariableDeclaration>(cloner.MapVariable(parameter), call->Arguments[i]));
+    }
+
+    for (auto &statement : body->Statements)
+        statements.push_back(cloner.RewriteStatement(statement));
+    statements.push_back(_arena->New<BoundLabelStatement>(end));
+
+    return needsResult ? _arena->New<BoundVariableExpression>(result) : nullptr;
+}
@@ -0,0 +1,403 @@
+#include "CodeAnalysis/Lowerer.h"
+#include "CodeAnalysis/ControlFlowGraph.h"
+#include "CodeAnalysis/Evaluator.h"
+#include <algorithm>
+
+static std::pair<SymbolKind, int> GetKey(const VariableSymbol &variable)
+{
+    return {variable.GetKind(), variable.Slot};
+}
+
+static BoundLiteralExpression *GetDefaultValue(Arena *arena, const TypeSymbol &type)
+{
+    if (type == TypeSymbol::Integer)
+        return arena->New<BoundLiteralExpression>("0", TypeSymbol::Integer);
+    if (type == TypeSymbol::Float)
+        return arena->New<BoundLiteralExpression>("0.0", TypeSymbol::Float);
+    if (type == TypeSymbol::String)
+        return arena->New<BoundLiteralExpression>("", TypeSymbol::String);
+    if (type == TypeSymbol::Boolean)
+        return arena->New<BoundLiteralExpression>("false", TypeSymbol::Boolean);
+    return arena->New<BoundLiteralExpression>("0", TypeSymbol::Any);
+}
+
+static bool IsLengthCall(BoundExpression *node)
+{
+    if (node->GetKind() != BoundNodeKind::CallExpression)
+        return false;
+
+    const FunctionSymbol &function = ((BoundCallExpression *)node)->Function;
+    return function == BuiltInFunctions::ArrayLength || function == BuiltInFunctions::StringLength;
+}
+
+class LoopScanner : public BoundTreeRewriter
+{
+public:
+    std::set<std::pair<SymbolKind, int>> &Assigned;
+    std::set<std::pair<SymbolKind, int>> &Stored;
+    bool &HasCalls;
+
+    LoopScanner(Arena *arena, std::set<std::pair<SymbolKind, int>> &assigned, std::set<std::pair<SymbolKind, int>> &stored, bool &hasCalls)
+        : BoundTreeRewriter(arena), Assigned(assigned), Stored(stored), HasCalls(hasCalls) {}
+
+protected:
+    BoundStatement *RewriteVariableDeclaration(BoundVariableDeclaration *node) override
+    {
+        Assigned.insert(GetKey(node->Variable));
+        return BoundTreeRewriter::RewriteVariableDeclaration(node);
+    }
+
+    BoundExpression *RewriteAssignmentExpression(BoundAssignmentExpression *node) override
+    {
+        Assigned.insert(GetKey(node->Variable));
+        return BoundTreeRewriter::RewriteAssignmentExpression(node);
+    }
+
+    BoundExpression *RewriteArrayAssignmentExpression(BoundArrayAssignmentExpression *node) override
+    {
+        Stored.insert(GetKey(node->Variable));
+        return BoundTreeRewriter::RewriteArrayAssignmentExpression(node);
+    }
+
+    BoundExpression *RewriteCallExpression(BoundCallExpression *node) override
+    {
+        if (!Evaluator::IsBuiltInFunction(node->Function))
+            HasCalls = true;
+        return BoundTreeRewriter::RewriteCallExpression(node);
+    }
+
+    BoundStatement *RewriteCountedGotoStatement(BoundCountedGotoStatement *node) override
+    {
+        Assigned.insert(GetKey(((BoundVariableExpression *)node->Variable)->Variable));
+        return BoundTreeRewriter::RewriteCountedGotoStatement(node);
+    }
+};
+
+// Moves expressions that cannot change while a loop runs into temporaries
+// assigned in front of the jump that enters the loop. Only expressions that
+// have no side effects and cannot fail are moved, since the loop may run
+// zero times or only reach them on some paths. The temporaries are declared
+// at the top of the body, ahead of every jump, because cyc emits gotos and
+// C++ does not allow jumping over an initialization.
+BoundBlockStatement *LoopInvariantHoister::Hoist(Arena *arena, BoundBlockStatement *body, int &localCount)
+{
+    LoopInvariantHoister hoister(arena);
+    hoister._localCount = &localCount;
+
+    BoundBlockStatement *flat = Lowerer::Flatten(arena, body);
+    hoister.FindLoops(flat);
+
+    for (auto &loop : hoister._loops)
+    {
+        for (auto &statement : flat->Statements)
+        {
+            if (!loop.Statements.count(statement))
+                continue;
+
+            switch (statement->GetKind())
+            {
+            case BoundNodeKind::VariableDeclaration:
+                hoister.Collect(((BoundVariableDeclaration *)statement)->Initializer, loop);
+                break;
+            case BoundNodeKind::ExpressionStatement:
+                hoister.Collect(((BoundExpressionStatement *)statement)->Expression, loop);
+                break;
+            case BoundNodeKind::ConditionalGotoStatement:
+                hoister.Collect(((BoundConditionalGotoStatement *)statement)->Condition, loop);
+                break;
+            case BoundNodeKind::ReturnStatement:
+                if (((BoundReturnStatement *)statement)->Expression != nullptr)
+                    hoister.Collect(((BoundReturnStatement *)statement)->Expression, loop);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (hoister._invariants.empty())
+        return body;
+
+    std::vector<BoundStatement *> statements;
+    for (auto &temporary : hoister._temporaries)
+        statements.push_back(arena->New<BoundVariableDeclaration>(temporary, GetDefaultValue(arena, temporary.Type)));
+
+    BoundBlockStatement *rewritten = (BoundBlockStatement *)hoister.RewriteStatement(body);
+    statements.insert(statements.end(), rewritten->Statements.begin(), rewritten->Statements.end());
+
+    BoundBlockStatement *result = arena->New<BoundBlockStatement>(statements);
+    result->LocalCount = localCount;
+    return result;
+}
+
+// Finds natural loops through the back edges of the control flow graph. A
+// loop is only kept when a single block outside it jumps to its header, so
+// that there is one place to put the temporaries. Outer loops come first.
+void LoopInvariantHoister::FindLoops(BoundBlockStatement *flat)
+{
+    ControlFlowGraph *graph = ControlFlowGraph::Create(flat);
+    std::unordered_map<ControlFlowGraph::BasicBlock *, size_t> indices;
+    for (size_t i = 0; i < graph->Blocks.size(); i++)
+        indices[graph->Blocks[i]] = i;
+
+    size_t count = graph->Blocks.size();
+    std::vector<std::vector<bool>> dominators(count, std::vector<bool>(count, true));
+    dominators[indices[graph->Start]] = std::vector<bool>(count, false);
+    dominators[indices[graph->Start]][indices[graph->Start]] = true;
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            ControlFlowGraph::BasicBlock *block = graph->Blocks[i];
+            if (block == graph->Start || block->Incoming.empty())
+                continue;
+
+            std::vector<bool> result(count, true);
+            for (auto &branch : block->Incoming)
+            {
+                const std::vector<bool> &incoming = dominators[indices[branch->From]];
+                for (size_t j = 0; j < count; j++)
+                    result[j] = result[j] && incoming[j];
+            }
+            result[i] = true;
+
+            if (result != dominators[i])
+            {
+                dominators[i] = std::move(result);
+                changed = true;
+            }
+        }
+    }
+
+    std::map<size_t, std::unordered_set<ControlFlowGraph::BasicBlock *>> regions;
+    for (auto &branch : graph->Branches)
+    {
+        size_t from = indices[branch->From];
+        size_t header = indices[branch->To];
+        if (!dominators[from][header])
+            continue;
+
+        std::unordered_set<ControlFlowGraph::BasicBlock *> &region = regions[header];
+        region.insert(branch->To);
+        std::vector<ControlFlowGraph::BasicBlock *> pending = {branch->From};
+        while (!pending.empty())
+        {
+            ControlFlowGraph::BasicBlock *block = pending.back();
+            pending.pop_back();
+            if (!region.insert(block).second)
+                continue;
+            for (auto &incoming : block->Incoming)
+                pending.push_back(incoming->From);
+        }
+    }
+
+    for (auto &[header, region] : regions)
+    {
+        ControlFlowGraph::BasicBlock *headerBlock = graph->Blocks[header];
+        if (headerBlock->Statements.empty() || headerBlock->Statements.front()->GetKind() != BoundNodeKind::LabelStatement)
+            continue;
+
+        ControlFlowGraph::BasicBlock *preheader = nullptr;
+        bool single = true;
+        for (auto &branch : headerBlock->Incoming)
+        {
+            if (region.count(branch->From))
+                continue;
+            single = single && (preheader == nullptr || preheader == branch->From);
+            preheader = branch->From;
+        }
+        if (preheader == nullptr || !single || preheader->Statements.empty())
+            continue;
+
+        // The loop is entered either by a jump to its header or, for a for
+        // loop, by falling through the bounds check in front of it.
+        BoundStatement *entry = preheader->Statements.back();
+        const BoundLabel &label = ((BoundLabelStatement *)headerBlock->Statements.front())->Label;
+        if (entry->GetKind() == BoundNodeKind::ConditionalGotoStatement)
+        {
+            std::set<std::pair<SymbolKind, int>> assigned;
+            std::set<std::pair<SymbolKind, int>> stored;
+            bool hasCalls = false;
+            LoopScanner scanner(_arena, assigned, stored, hasCalls);
+            scanner.RewriteStatement(entry);
+            if (!assigned.empty() || !stored.empty() || hasCalls)
+                continue;
+        }
+        else if (entry->GetKind() != BoundNodeKind::GotoStatement || !(((BoundGotoStatement *)entry)->Label == label))
+            continue;
+
+        Loop loop;
+        loop.Entry = entry;
+        LoopScanner scanner(_arena, loop.Assigned, loop.Stored, loop.HasCalls);
+        for (auto &block : region)
+        {
+            for (auto &statement : block->Statements)
+            {
+                loop.Statements.insert(statement);
+                scanner.RewriteStatement(statement);
+            }
+        }
+        _loops.push_back(std::move(loop));
+    }
+    delete graph;
+
+    std::stable_sort(_loops.begin(), _loops.end(), [](const Loop &left, const Loop &right)
+                     { return left.Statements.size() > right.Statements.size(); });
+}
+
+bool LoopInvariantHoister::IsInvariant(BoundExpression *node, const Loop &loop) const
+{
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::LiteralExpression:
+        return true;
+    case BoundNodeKind::VariableExpression:
+    {
+        const VariableSymbol &variable = ((BoundVariableExpression *)node)->Variable;
+        if (loop.Assigned.count(GetKey(variable)) || loop.Stored.count(GetKey(variable)))
+            return false;
+        return variable.GetKind() != SymbolKind::GlobalVariable || !loop.HasCalls;
+    }
+    case BoundNodeKind::UnaryExpression:
+        return IsInvariant(((BoundUnaryExpression *)node)->Operand, loop);
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        if (binary->Op->Kind == BoundBinaryOperatorKind::Division &&
+            (binary->Right->GetKind() != BoundNodeKind::LiteralExpression || ((BoundLiteralExpression *)binary->Right)->Value == "0"))
+            return false;
+        return IsInvariant(binary->Left, loop) && IsInvariant(binary->Right, loop);
+    }
+    case BoundNodeKind::ConversionExpression:
+    {
+        BoundConversionExpression *conversion = (BoundConversionExpression *)node;
+        if (conversion->type != TypeSymbol::String && conversion->Expression->type == TypeSymbol::String)
+            return false;
+        return IsInvariant(conversion->Expression, loop);
+    }
+    case BoundNodeKind::CallExpression:
+    {
+        // Storing an element does not change the length, so only a full
+        // assignment of the argument makes size() or len() vary.
+        BoundCallExpression *call = (BoundCallExpression *)node;
+        if (!IsLengthCall(call))
+            return false;
+        BoundExpression *argument = call->Arguments[0];
+        if (argument->GetKind() != BoundNodeKind::VariableExpression)
+            return IsInvariant(argument, loop);
+
+        const VariableSymbol &variable = ((BoundVariableExpression *)argument)->Variable;
+        if (loop.Assigned.count(GetKey(variable)))
+            return false;
+        return variable.GetKind() != SymbolKind::GlobalVariable || !loop.HasCalls;
+    }
+    default:
+        return false;
+    }
+}
+
+void LoopInvariantHoister::Collect(BoundExpression *node, const Loop &loop)
+{
+    if (_invariants.count(node))
+        return;
+
+    BoundNodeKind kind = node->GetKind();
+    bool candidate = kind == BoundNodeKind::UnaryExpression || kind == BoundNodeKind::BinaryExpression ||
+                     kind == BoundNodeKind::ConversionExpression || IsLengthCall(node);
+    if (candidate && !node->type.IsArray() && IsInvariant(node, loop))
+    {
+        LocalVariableSymbol temporary("loopInvariant" + std::to_string(*_localCount), false, node->type);
+        temporary.Slot = (*_localCount)++;
+        _temporaries.push_back(temporary);
+        _invariants.emplace(node, Invariant{temporary, &loop});
+        _preheaders[loop.Entry].push_back(node);
+        return;
+    }
+
+    switch (kind)
+    {
+    case BoundNodeKind::UnaryExpression:
+        Collect(((BoundUnaryExpression *)node)->Operand, loop);
+        break;
+    case BoundNodeKind::BinaryExpression:
+        Collect(((BoundBinaryExpression *)node)->Left, loop);
+        Collect(((BoundBinaryExpression *)node)->Right, loop);
+        break;
+    case BoundNodeKind::ConversionExpression:
+        Collect(((BoundConversionExpression *)node)->Expression, loop);
+        break;
+    case BoundNodeKind::AssignmentExpression:
+        Collect(((BoundAssignmentExpression *)node)->Expression, loop);
+        break;
+    case BoundNodeKind::ArrayAccessExpression:
+        Collect(((BoundArrayAccessExpression *)node)->Index, loop);
+        break;
+    case BoundNodeKind::ArrayAssignmentExpression:
+        Collect(((BoundArrayAssignmentExpression *)node)->Index, loop);
+        Collect(((BoundArrayAssignmentExpression *)node)->Expression, loop);
+        break;
+    case BoundNodeKind::CallExpression:
+        for (auto &argument : ((BoundCallExpression *)node)->Arguments)
+            Collect(argument, loop);
+        break;
+    case BoundNodeKind::ArrayInitializerExpression:
+        for (auto &element : ((BoundArrayInitializerExpression *)node)->Elements)
+            Collect(element, loop);
+        break;
+    default:
+        break;
+    }
+}
+
+BoundStatement *LoopInvariantHoister::RewriteStatement(BoundStatement *node)
+{
+    if (node->GetKind() != BoundNodeKind::BlockStatement)
+        _current = node;
+    return BoundTreeRewriter::RewriteStatement(node);
+}
+
+// Preheader assignments go into the block that holds the loop entry rather
+// than a block of their own.
+BoundStatement *LoopInvariantHoister::RewriteBlockStatement(BoundBlockStatement *node)
+{
+    std::vector<BoundStatement *> statements;
+    bool changed = false;
+
+    for (auto &statement : node->Statements)
+    {
+        auto it = _preheaders.find(statement);
+        if (it != _preheaders.end())
+        {
+            for (auto &expression : it->second)
+            {
+                _current = statement;
+                BoundExpression *initializer = BoundTreeRewriter::RewriteExpression(expression);
+                BoundExpression *assignment = _arena->New<BoundAssignmentExpression>(_invariants.at(expression).Temporary, initializer);
+                statements.push_back(_arena->New<BoundExpressionStatement>(assignment));
+            }
+            changed = true;
+        }
+
+        BoundStatement *result = RewriteStatement(statement);
+        changed |= result != statement;
+        statements.push_back(result);
+    }
+
+    if (!changed)
+        return node;
+    return _arena->New<BoundBlockStatement>(statements);
+}
+
+BoundExpression *LoopInvariantHoister::RewriteExpression(BoundExpression *node)
+{
+    auto it = _invariants.find(node);
+    if (it == _invariants.end() || !it->second.Owner->Statements.count(_current))
+        return BoundTreeRewriter::RewriteExpression(node);
+
+    BoundExpression *result = _arena->New<BoundVariableExpression>(it->second.Temporary);
+    result->type = node->type;
+    return result;
+}
@@ -1,16 +1,26 @@
 #include "CodeAnalysis/Lowerer.h"
+#include <stdexcept>
 
-BoundBlockStatement *Lowerer::Lower(BoundStatement *node)
+BoundBlockStatement *Lowerer::Lower(Arena *arena, BoundStatement *node, int localCount)
 {
-    Lowerer lowerer;
-    BoundStatement *result = lowerer.RewriteStatement(node);
-    return Flatten(static_cast<BoundBlockStatement *>(result));
+    Lowerer lowerer(arena);
+    lowerer.localCount = localCount;
+    BoundStatement *result = ConstantFolder::Fold(arena, lowerer.RewriteStatement(node));
+    BoundBlockStatement *block = Flatten(arena, DeadCodeEliminator::Eliminate(arena, Flatten(arena, result)));
+    block = LoopInvariantHoister::Hoist(arena, block, lowerer.localCount);
+    block->LocalCount = lowerer.localCount;
+    ResolveLabels(block);
+    return block;
 }
-BoundBlockStatement *Lowerer::LowerEmitable(BoundStatement *node)
+BoundBlockStatement *Lowerer::LowerEmitable(Arena *arena, BoundStatement *node, int localCount)
 {
-    Lowerer lowerer;
-    BoundStatement *result = lowerer.RewriteStatement(node);
-    return static_cast<BoundBlockStatement *>(result);
+    Lowerer lowerer(arena);
+    lowerer.localCount = localCount;
+    BoundStatement *result = ConstantFolder::Fold(arena, lowerer.RewriteStatement(node));
+    BoundBlockStatement *block = DeadCodeEliminator::Eliminate(arena, static_cast<BoundBlockStatement *>(result));
+    block = LoopInvariantHoister::Hoist(arena, block, lowerer.localCount);
+    block->LocalCount = lowerer.localCount;
+    return block;
 }
 
 BoundStatement *Lowerer::RewriteIfStatement(BoundIfStatement *node)
@@ -18,9 +28,9 @@ BoundStatement *Lowerer::RewriteIfStatement(BoundIfStatement *node)
     if (node->ElseStatement == nullptr)
     {
         BoundLabel *endLabel = GenerateLabel();
-        BoundStatement *gotoFalse = new BoundConditionalGotoStatement(*endLabel, node->Condition, false);
-        BoundStatement *endLabelStatement = new BoundLabelStatement(*endLabel);
-        BoundBlockStatement *result = new BoundBlockStatement({gotoFalse, node->ThenStatement, endLabelStatement});
+        BoundStatement *gotoFalse = _arena->New<BoundConditionalGotoStatement>(*endLabel, node->Condition, false);
+        BoundStatement *endLabelStatement = _arena->New<BoundLabelStatement>(*endLabel);
+        BoundBlockStatement *result = _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>{gotoFalse, node->ThenStatement, endLabelStatement});
         return RewriteStatement(result);
     }
     else
@@ -28,11 +38,11 @@ BoundStatement *Lowerer::RewriteIfStatement(BoundIfStatement *node)
 
         BoundLabel *elseLabel = GenerateLabel();
         BoundLabel *endLabel = GenerateLabel();
-        BoundStatement *gotoFalse = new BoundConditionalGotoStatement(*elseLabel, node->Condition, false);
-        BoundStatement *gotoEnd = new BoundGotoStatement(*endLabel);
-        BoundStatement *elseLabelStatement = new BoundLabelStatement(*elseLabel);
-        BoundStatement *endLabelStatement = new BoundLabelStatement(*endLabel);
-        BoundBlockStatement *result = new BoundBlockStatement({gotoFalse, node->ThenStatement, gotoEnd, elseLabelStatement, node->ElseStatement, endLabelStatement});
+        BoundStatement *gotoFalse = _arena->New<BoundConditionalGotoStatement>(*elseLabel, node->Condition, false);
+        BoundStatement *gotoEnd = _arena->New<BoundGotoStatement>(*endLabel);
+        BoundStatement *elseLabelStatement = _arena->New<BoundLabelStatement>(*elseLabel);
+        BoundStatement *endLabelStatement = _arena->New<BoundLabelStatement>(*endLabel);
+        BoundBlockStatement *result = _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>{gotoFalse, node->ThenStatement, gotoEnd, elseLabelStatement, node->ElseStatement, endLabelStatement});
         return RewriteStatement(result);
     }
 }
@@ -41,47 +51,58 @@ BoundStatement *Lowerer::RewriteWhileStatement(BoundWhileStatement *node)
 {
     BoundLabel *bodyLabel = GenerateLabel();
 
-    BoundGotoStatement *gotoContinue = new BoundGotoStatement(*node->ContinueLabel);
-    BoundLabelStatement *bodyLabelStatement = new BoundLabelStatement(*bodyLabel);
+    BoundGotoStatement *gotoContinue = _arena->New<BoundGotoStatement>(*node->ContinueLabel);
+    BoundLabelStatement *bodyLabelStatement = _arena->New<BoundLabelStatement>(*bodyLabel);
 
-    BoundLabelStatement *continueLabelStatement = new BoundLabelStatement(*node->ContinueLabel);
+    BoundLabelStatement *continueLabelStatement = _arena->New<BoundLabelStatement>(*node->ContinueLabel);
 
-    BoundConditionalGotoStatement *gotoTrue = new BoundConditionalGotoStatement(*bodyLabel, node->Condition);
-    BoundLabelStatement *breakLabelStatement = new BoundLabelStatement(*node->BreakLabel);
+    BoundConditionalGotoStatement *gotoTrue = _arena->New<BoundConditionalGotoStatement>(*bodyLabel, node->Condition);
+    BoundLabelStatement *breakLabelStatement = _arena->New<BoundLabelStatement>(*node->BreakLabel);
 
-    BoundBlockStatement *result = new BoundBlockStatement({gotoContinue,
-                                                           bodyLabelStatement,
-                                                           node->Body,
-                                                           continueLabelStatement,
-                                                           gotoTrue,
-                                                           breakLabelStatement});
+    BoundBlockStatement *result = _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>{gotoContinue,
+                                                                                                 bodyLabelStatement,
+                                                                                                 node->Body,
+                                                                                                 continueLabelStatement,
+                                                                                                 gotoTrue,
+                                                                                                 breakLabelStatement});
     return RewriteStatement(result);
 }
 
+// A for loop checks its bounds once on entry and then closes with a single
+// counted goto, instead of the separate increment and comparison a while
+// loop would need.
 BoundStatement *Lowerer::RewriteForStatement(BoundForStatement *node)
 {
-    BoundVariableDeclaration *variableDeclaration = new BoundVariableDeclaration(node->Variable, node->LowerBound);
-    BoundVariableExpression *variableExpression = new BoundVariableExpression(node->Variable);
+    BoundVariableDeclaration *variableDeclaration = _arena->New<BoundVariableDeclaration>(node->Variable, node->LowerBound);
+    BoundVariableExpression *variableExpression = _arena->New<BoundVariableExpression>(node->Variable);
 
-    LocalVariableSymbol *upperBoundSymbol = new LocalVariableSymbol("upperBound", true, TypeSymbol::Integer);
-    BoundVariableDeclaration *upperBoundDeclaration = new BoundVariableDeclaration(*upperBoundSymbol, node->UpperBound);
+    LocalVariableSymbol upperBoundSymbol("upperBound", true, TypeSymbol::Integer);
+    upperBoundSymbol.Slot = localCount++;
+    BoundVariableDeclaration *upperBoundDeclaration = _arena->New<BoundVariableDeclaration>(upperBoundSymbol, node->UpperBound);
 
-    BoundBinaryOperator *lessOrEquals = BoundBinaryOperator::Bind(SyntaxKind::LESS_EQUALS, TypeSymbol::Integer, TypeSymbol::Integer);
-    BoundBinaryExpression *condition = new BoundBinaryExpression(variableExpression, lessOrEquals, new BoundVariableExpression(*upperBoundSymbol));
+    const BoundBinaryOperator *lessOrEquals = BoundBinaryOperator::Bind(SyntaxKind::LESS_EQUALS, TypeSymbol::Integer, TypeSymbol::Integer);
+    BoundBinaryExpression *condition = _arena->New<BoundBinaryExpression>(variableExpression, lessOrEquals, _arena->New<BoundVariableExpression>(upperBoundSymbol));
 
-    BoundLabelStatement *continueLabelStatement = new BoundLabelStatement(*node->ContinueLabel);
-    BoundExpressionStatement *increment = new BoundExpressionStatement(new BoundAssignmentExpression(node->Variable, new BoundBinaryExpression(variableExpression, BoundBinaryOperator::Bind(SyntaxKind::PLUS, TypeSymbol::Integer, TypeSymbol::Integer), new BoundLiteralExpression("1", TypeSymbol::Integer))));
-
-    BoundBlockStatement *whileBody = new BoundBlockStatement({node->Body, continueLabelStatement, increment});
-    BoundWhileStatement *whileStatement = new BoundWhileStatement(condition, whileBody, node->BreakLabel, GenerateLabel());
-    BoundBlockStatement *result = new BoundBlockStatement({variableDeclaration,
-                                                           upperBoundDeclaration,
-                                                           whileStatement});
+    BoundLabel *bodyLabel = GenerateLabel();
+    BoundConditionalGotoStatement *gotoBreak = _arena->New<BoundConditionalGotoStatement>(*node->BreakLabel, condition, false);
+    BoundLabelStatement *bodyLabelStatement = _arena->New<BoundLabelStatement>(*bodyLabel);
+    BoundLabelStatement *continueLabelStatement = _arena->New<BoundLabelStatement>(*node->ContinueLabel);
+    BoundCountedGotoStatement *countedGoto = _arena->New<BoundCountedGotoStatement>(*bodyLabel, _arena->New<BoundVariableExpression>(node->Variable), _arena->New<BoundVariableExpression>(upperBoundSymbol));
+    BoundLabelStatement *breakLabelStatement = _arena->New<BoundLabelStatement>(*node->BreakLabel);
+
+    BoundBlockStatement *result = _arena->New<BoundBlockStatement>(std::vector<BoundStatement *>{variableDeclaration,
+                                                                                                 upperBoundDeclaration,
+                                                                                                 gotoBreak,
+                                                                                                 bodyLabelStatement,
+                                                                                                 node->Body,
+                                                                                                 continueLabelStatement,
+                                                                                                 countedGoto,
+                                                                                                 breakLabelStatement});
 
     return RewriteStatement(result);
 }
 
-BoundBlockStatement *Lowerer::Flatten(BoundStatement *node)
+BoundBlockStatement *Lowerer::Flatten(Arena *arena, BoundStatement *node)
 {
     std::vector<BoundStatement *> statements;
     std::stack<BoundStatement *> stack;
@@ -106,10 +127,48 @@ BoundBlockStatement *Lowerer::Flatten(BoundStatement *node)
         }
     }
 
-    return new BoundBlockStatement(statements);
+    return arena->New<BoundBlockStatement>(statements);
+}
+
+void Lowerer::ResolveLabels(BoundBlockStatement *block)
+{
+    std::unordered_map<BoundLabel, int> labelToIndex;
+    for (size_t i = 0; i < block->Statements.size(); i++)
+    {
+        if (block->Statements[i]->GetKind() == BoundNodeKind::LabelStatement)
+            labelToIndex[static_cast<BoundLabelStatement *>(block->Statements[i])->Label] = i + 1;
+    }
+
+    auto resolve = [&labelToIndex](const BoundLabel &label)
+    {
+        auto it = labelToIndex.find(label);
+        if (it == labelToIndex.end())
+            throw std::runtime_error("Undefined label: " + label.Name);
+        return it->second;
+    };
+
+    for (auto &statement : block->Statements)
+    {
+        if (statement->GetKind() == BoundNodeKind::GotoStatement)
+        {
+            BoundGotoStatement *gotoStatement = static_cast<BoundGotoStatement *>(statement);
+            gotoStatement->Target = resolve(gotoStatement->Label);
+        }
+        else if (statement->GetKind() == BoundNodeKind::ConditionalGotoStatement)
+        {
+            BoundConditionalGotoStatement *gotoStatement = static_cast<BoundConditionalGotoStatement *>(statement);
+            gotoStatement->Target = resolve(gotoStatement->Label);
+        }
+        else if (statement->GetKind() == BoundNodeKind::CountedGotoStatement)
+        {
+            BoundCountedGotoStatement *gotoStatement = static_cast<BoundCountedGotoStatement *>(statement);
+            gotoStatement->Target = resolve(gotoStatement->Label);
+        }
+    }
+    block->LabelsResolved = true;
 }
 
 BoundLabel *Lowerer::GenerateLabel()
 {
-    return new BoundLabel("Label" + std::to_string(++labelCount));
+    return _arena->New<BoundLabel>("Label" + std::to_string(++labelCount));
 }
\ No newline at end of file
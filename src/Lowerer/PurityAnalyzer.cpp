@@ -0,0 +1,70 @@
+#include "CodeAnalysis/Lowerer.h"
+#include "CodeAnalysis/Evaluator.h"
+
+// A function is pure when it only touches its parameters and locals, calls
+// no built-in with side effects and calls only pure functions. Functions
+// start out pure and lose it until nothing changes, so recursion is fine.
+void PurityAnalyzer::Analyze(BoundProgram *program)
+{
+    std::unordered_map<FunctionSymbol, std::vector<FunctionSymbol>> callees;
+    for (auto &[function, body] : program->Functions)
+    {
+        PurityAnalyzer analyzer(&program->Nodes);
+        analyzer.RewriteStatement(body);
+        if (!analyzer._impure)
+            callees[function] = std::move(analyzer._callees);
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto it = callees.begin(); it != callees.end();)
+        {
+            bool pure = true;
+            for (auto &callee : it->second)
+                pure = pure && (Evaluator::IsBuiltInFunction(callee) || callees.count(callee));
+
+            if (pure)
+                ++it;
+            else
+            {
+                it = callees.erase(it);
+                changed = true;
+            }
+        }
+    }
+
+    for (auto &[function, calls] : callees)
+        program->PureFunctions.insert(function);
+}
+
+BoundExpression *PurityAnalyzer::RewriteVariableExpression(BoundVariableExpression *node)
+{
+    if (node->Variable.GetKind() == SymbolKind::GlobalVariable)
+        _impure = true;
+    return node;
+}
+
+BoundExpression *PurityAnalyzer::RewriteAssignmentExpression(BoundAssignmentExpression *node)
+{
+    if (node->Variable.GetKind() == SymbolKind::GlobalVariable)
+        _impure = true;
+    return BoundTreeRewriter::RewriteAssignmentExpression(node);
+}
+
+BoundExpression *PurityAnalyzer::RewriteArrayAssignmentExpression(BoundArrayAssignmentExpression *node)
+{
+    if (node->Variable.GetKind() == SymbolKind::GlobalVariable)
+        _impure = true;
+    return BoundTreeRewriter::RewriteArrayAssignmentExpression(node);
+}
+
+BoundExpression *PurityAnalyzer::RewriteCallExpression(BoundCallExpression *node)
+{
+    if (Evaluator::IsBuiltInFunction(node->Function))
+        _impure = _impure || !BuiltInFunctions::GetAll()[node->Function.BuiltIn].IsPure;
+    else
+        _callees.push_back(node->Function);
+    return BoundTreeRewriter::RewriteCallExpression(node);
+}
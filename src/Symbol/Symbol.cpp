@@ -1,5 +1,20 @@
 #include "CodeAnalysis/Symbol.h"
 #include "CodeAnalysis/IndentedTextWriter.h"
+#include <cstdlib>
+#include <iostream>
+
+std::vector<const TypeSymbol *> &TypeSymbol::Registry()
+{
+    static std::vector<const TypeSymbol *> registry = {nullptr};
+    return registry;
+}
+
+int TypeSymbol::Register(const TypeSymbol *type)
+{
+    Registry().push_back(type);
+    return Registry().size() - 1;
+}
+
 const TypeSymbol TypeSymbol::Integer("int");
 const TypeSymbol TypeSymbol::Float("float");
 const TypeSymbol TypeSymbol::Boolean("bool");
@@ -8,17 +23,67 @@ const TypeSymbol TypeSymbol::Void("void");
 const TypeSymbol TypeSymbol::Error("?");
 const TypeSymbol TypeSymbol::Null("null");
 const TypeSymbol TypeSymbol::Any("any");
-const TypeSymbol TypeSymbol::ArrayInt("array<int>");
-const TypeSymbol TypeSymbol::ArrayFloat("array<float>");
-const TypeSymbol TypeSymbol::ArrayBool("array<bool>");
-const TypeSymbol TypeSymbol::ArrayString("array<string>");
-const TypeSymbol TypeSymbol::ArrayAny("array<any>");
-
-const FunctionSymbol BuiltInFunctions::Print("print", std::vector<ParameterSymbol>{ParameterSymbol("text", TypeSymbol::String)}, TypeSymbol::Void);
-const FunctionSymbol BuiltInFunctions::Input("input", std::vector<ParameterSymbol>{}, TypeSymbol::String);
-const FunctionSymbol BuiltInFunctions::Random("random", std::vector<ParameterSymbol>{ParameterSymbol("max", TypeSymbol::Integer)}, TypeSymbol::Integer);
-const FunctionSymbol BuiltInFunctions::ArrayLength("size", std::vector<ParameterSymbol>{ParameterSymbol("array", TypeSymbol::ArrayAny)}, TypeSymbol::Integer);
-const FunctionSymbol BuiltInFunctions::StringLength("len", std::vector<ParameterSymbol>{ParameterSymbol("text", TypeSymbol::String)}, TypeSymbol::Integer);
+const TypeSymbol TypeSymbol::ArrayInt("array<int>", &TypeSymbol::Integer);
+const TypeSymbol TypeSymbol::ArrayFloat("array<float>", &TypeSymbol::Float);
+const TypeSymbol TypeSymbol::ArrayBool("array<bool>", &TypeSymbol::Boolean);
+const TypeSymbol TypeSymbol::ArrayString("array<string>", &TypeSymbol::String);
+const TypeSymbol TypeSymbol::ArrayAny("array<any>", &TypeSymbol::Any);
+
+static FunctionSymbol DeclareBuiltIn(std::string name, std::vector<ParameterSymbol> parameters, TypeSymbol type)
+{
+    static int count = 0;
+    FunctionSymbol function(name, parameters, type);
+    function.BuiltIn = count++;
+    return function;
+}
+
+// GetAll() lists the builtins in this order, so BuiltIn indexes into it.
+const FunctionSymbol BuiltInFunctions::Print = DeclareBuiltIn("print", {ParameterSymbol("text", TypeSymbol::String)}, TypeSymbol::Void);
+const FunctionSymbol BuiltInFunctions::Input = DeclareBuiltIn("input", {}, TypeSymbol::String);
+const FunctionSymbol BuiltInFunctions::Random = DeclareBuiltIn("random", {ParameterSymbol("max", TypeSymbol::Integer)}, TypeSymbol::Integer);
+const FunctionSymbol BuiltInFunctions::ArrayLength = DeclareBuiltIn("size", {ParameterSymbol("array", TypeSymbol::ArrayAny)}, TypeSymbol::Integer);
+const FunctionSymbol BuiltInFunctions::StringLength = DeclareBuiltIn("len", {ParameterSymbol("text", TypeSymbol::String)}, TypeSymbol::Integer);
+
+static Value CallPrint(const Value *arguments)
+{
+    std::cout << arguments[0].AsString();
+    return arguments[0];
+}
+
+static Value CallInput(const Value *)
+{
+    std::string input;
+    std::cin >> input;
+    std::cout << "\n";
+    return Value(input);
+}
+
+static Value CallRandom(const Value *arguments)
+{
+    return Value((long long)(rand() % arguments[0].AsInteger()));
+}
+
+static Value CallArrayLength(const Value *arguments)
+{
+    return Value((long long)arguments[0].AsArray().Size());
+}
+
+static Value CallStringLength(const Value *arguments)
+{
+    return Value((long long)arguments[0].AsString().size());
+}
+
+const std::vector<BuiltInFunction> &BuiltInFunctions::GetAll()
+{
+    static const std::vector<BuiltInFunction> builtIns = {
+        {Print, CallPrint, "std::cout << $0", false},
+        {Input, CallInput, "", false},
+        {Random, CallRandom, "rand() % $0", false},
+        {ArrayLength, CallArrayLength, "$0.size()", true},
+        {StringLength, CallStringLength, "$0.size()", true},
+    };
+    return builtIns;
+}
 
 void Symbol::WriteTo(std::ostream &os)
 {
@@ -6,25 +6,25 @@
 #include "CodeAnalysis/Diagnostic.h"
 #include "Utils.h"
 
-std::vector<Token> Lexer::tokenize()
+std::vector<SyntaxToken> Lexer::tokenize()
 {
-    std::vector<Token> tokens;
+    std::vector<SyntaxToken> tokens;
     while (currentChar != '\0')
     {
         switch (currentChar)
         {
         case '+':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::PLUS, "+", pos});
+            tokens.push_back(MakeToken(SyntaxKind::PLUS, pos, 1));
             advance();
             break;
 
         case '-':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::MINUS, "-", pos});
+            tokens.push_back(MakeToken(SyntaxKind::MINUS, pos, 1));
             advance();
             break;
 
         case '*':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::MULTIPLY, "*", pos});
+            tokens.push_back(MakeToken(SyntaxKind::MULTIPLY, pos, 1));
             advance();
             break;
 
@@ -39,127 +39,127 @@ std::vector<Token> Lexer::tokenize()
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::DIVIDE, "/", pos});
+                tokens.push_back(MakeToken(SyntaxKind::DIVIDE, pos, 1));
                 advance();
             }
             break;
 
         case '(':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::LPAREN, "(", pos});
+            tokens.push_back(MakeToken(SyntaxKind::LPAREN, pos, 1));
             advance();
             break;
 
         case ')':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::RPAREN, ")", pos});
+            tokens.push_back(MakeToken(SyntaxKind::RPAREN, pos, 1));
             advance();
             break;
         case '{':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::OPEN_BRACE, "{", pos});
+            tokens.push_back(MakeToken(SyntaxKind::OPEN_BRACE, pos, 1));
             advance();
             break;
         case '}':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::CLOSE_BRACE, "}", pos});
+            tokens.push_back(MakeToken(SyntaxKind::CLOSE_BRACE, pos, 1));
             advance();
             break;
         case '[':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::OPEN_BRACKET, "[", pos});
+            tokens.push_back(MakeToken(SyntaxKind::OPEN_BRACKET, pos, 1));
             advance();
             break;
         case ']':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::CLOSE_BRACKET, "]", pos});
+            tokens.push_back(MakeToken(SyntaxKind::CLOSE_BRACKET, pos, 1));
             advance();
             break;
         case ':':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::COLON, ":", pos});
+            tokens.push_back(MakeToken(SyntaxKind::COLON, pos, 1));
             advance();
             break;
         case ',':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::COMMA, ",", pos});
+            tokens.push_back(MakeToken(SyntaxKind::COMMA, pos, 1));
             advance();
             break;
         case '~':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::TILDE, "~", pos});
+            tokens.push_back(MakeToken(SyntaxKind::TILDE, pos, 1));
             advance();
             break;
         case '^':
-            tokens.push_back(Token{_syntaxTree, SyntaxKind::HAT, "^", pos});
+            tokens.push_back(MakeToken(SyntaxKind::HAT, pos, 1));
             advance();
             break;
         case '&':
             if (lookAhead == '&')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::AMPERSAND_AMPERSAND, "&&", pos});
+                tokens.push_back(MakeToken(SyntaxKind::AMPERSAND_AMPERSAND, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::AMPERSAND, "&", pos});
+                tokens.push_back(MakeToken(SyntaxKind::AMPERSAND, pos, 1));
                 advance();
             }
             break;
         case '|':
             if (lookAhead == '|')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::PIPE_PIPE, "||", pos});
+                tokens.push_back(MakeToken(SyntaxKind::PIPE_PIPE, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::PIPE, "|", pos});
+                tokens.push_back(MakeToken(SyntaxKind::PIPE, pos, 1));
                 advance();
             }
             break;
         case '=':
             if (lookAhead == '=')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::EQUALS_EQUALS, "==", pos});
+                tokens.push_back(MakeToken(SyntaxKind::EQUALS_EQUALS, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::EQUALS, "=", pos});
+                tokens.push_back(MakeToken(SyntaxKind::EQUALS, pos, 1));
                 advance();
             }
             break;
         case '!':
             if (lookAhead == '=')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::BANG_EQUALS, "!=", pos});
+                tokens.push_back(MakeToken(SyntaxKind::BANG_EQUALS, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::BANG, "!", pos});
+                tokens.push_back(MakeToken(SyntaxKind::BANG, pos, 1));
                 advance();
             }
             break;
         case '<':
             if (lookAhead == '=')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::LESS_EQUALS, "<=", pos});
+                tokens.push_back(MakeToken(SyntaxKind::LESS_EQUALS, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::LESS, "<", pos});
+                tokens.push_back(MakeToken(SyntaxKind::LESS, pos, 1));
                 advance();
             }
             break;
         case '>':
             if (lookAhead == '=')
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::GREATER_EQUALS, ">=", pos});
+                tokens.push_back(MakeToken(SyntaxKind::GREATER_EQUALS, pos, 2));
                 advance();
                 advance();
             }
             else
             {
-                tokens.push_back(Token{_syntaxTree, SyntaxKind::GREATER, ">", pos});
+                tokens.push_back(MakeToken(SyntaxKind::GREATER, pos, 1));
                 advance();
             }
             break;
@@ -212,15 +212,15 @@ std::vector<Token> Lexer::tokenize()
             break;
         }
     }
-    tokens.push_back(Token{_syntaxTree, SyntaxKind::END_OF_FILE, "", pos});
-    // std::cout << "TOKENS: " << std::endl;
-    // for (auto token : tokens)
-    // {
-    //     std::cout << "  " << convertSyntaxKindToString(token.Kind) << " " << token.value << std::endl;
-    // }
+    tokens.push_back(MakeToken(SyntaxKind::END_OF_FILE, pos, 0));
     return tokens;
 }
 
+SyntaxToken Lexer::MakeToken(SyntaxKind kind, size_t start, size_t length)
+{
+    return SyntaxToken{kind, static_cast<uint32_t>(start), static_cast<uint32_t>(length)};
+}
+
 void Lexer::advance()
 {
     pos++;
@@ -235,11 +235,14 @@ void Lexer::advance()
     }
 }
 
-Token Lexer::GenerateStringToken()
+SyntaxToken Lexer::GenerateStringToken()
 {
     size_t start = pos;
 
+    // The decoded text is only built once an escape makes it differ from
+    // the source.
     std::string result;
+    bool decoded = false;
     bool done = false;
     advance();
     // while (currentChar != '"')
@@ -263,13 +266,18 @@ Token Lexer::GenerateStringToken()
             TextSpan span(start, 1);
             TextLocation location(_syntaxTree->Text, span);
             _diagnostics.ReportUnterminatedString(location);
-            return Token{_syntaxTree, SyntaxKind::BAD_TOKEN, input.ToString(start, pos - start), start};
+            return MakeToken(SyntaxKind::BAD_TOKEN, start, pos - start);
         }
         case '"':
         case '\'':
             done = true;
             break;
         case '\\':
+            if (!decoded)
+            {
+                result = input.ToString(start + 1, pos - start - 1);
+                decoded = true;
+            }
             advance();
             switch (currentChar)
             {
@@ -299,33 +307,38 @@ Token Lexer::GenerateStringToken()
             advance();
             break;
         default:
-            result += currentChar;
+            if (decoded)
+                result += currentChar;
             advance();
             break;
         }
     }
     advance();
-    return Token{_syntaxTree, SyntaxKind::STRING, result, start};
+    SyntaxToken token = MakeToken(SyntaxKind::STRING, start, pos - start);
+    if (decoded)
+    {
+        token.Literal = static_cast<int32_t>(_syntaxTree->Literals.size());
+        _syntaxTree->Literals.push_back(std::move(result));
+    }
+    return token;
 }
 
-Token Lexer::GenerateWhitespaceToken()
+SyntaxToken Lexer::GenerateWhitespaceToken()
 {
     while (isspace(currentChar))
     {
         advance();
     }
-    return Token{_syntaxTree, SyntaxKind::WHITESPACE, " ", pos};
+    return MakeToken(SyntaxKind::WHITESPACE, pos, 1);
 }
 
-Token Lexer::GenerateNumberToken()
+SyntaxToken Lexer::GenerateNumberToken()
 {
     size_t start = pos;
-    std::string result;
 
     // Read the integer part
     while (pos < input.Length() && isdigit(currentChar))
     {
-        result += currentChar;
         advance();
     }
 
@@ -334,7 +347,6 @@ Token Lexer::GenerateNumberToken()
     if (currentChar == '.')
     {
         hasDecimalPoint = true;
-        result += currentChar;
         advance();
 
         // Ensure there are digits after the decimal point
@@ -342,14 +354,13 @@ Token Lexer::GenerateNumberToken()
         {
             TextSpan span(start, pos - start);
             TextLocation location(_syntaxTree->Text, span);
-            _diagnostics.ReportInvalidNumber(location, result, "float");
-            return Token{_syntaxTree, SyntaxKind::BAD_TOKEN, result, start};
+            _diagnostics.ReportInvalidNumber(location, input.ToString(span), "float");
+            return MakeToken(SyntaxKind::BAD_TOKEN, start, pos - start);
         }
 
         // Read the fractional part
         while (pos < input.Length() && isdigit(currentChar))
         {
-            result += currentChar;
             advance();
         }
     }
@@ -359,19 +370,18 @@ Token Lexer::GenerateNumberToken()
     {
         while (isalnum(currentChar))
         {
-            result += currentChar;
             advance();
         }
 
         TextSpan span(start, pos - start);
         TextLocation location(_syntaxTree->Text, span);
-        _diagnostics.ReportInvalidNumber(location, result, hasDecimalPoint ? "float" : "int");
-        return Token{_syntaxTree, SyntaxKind::BAD_TOKEN, result, start};
+        _diagnostics.ReportInvalidNumber(location, input.ToString(span), hasDecimalPoint ? "float" : "int");
+        return MakeToken(SyntaxKind::BAD_TOKEN, start, pos - start);
     }
 
     // Determine the appropriate token kind based on the presence of a decimal point
     SyntaxKind kind = hasDecimalPoint ? SyntaxKind::DECIMAL : SyntaxKind::NUMBER;
-    return Token{_syntaxTree, kind, result, start};
+    return MakeToken(kind, start, pos - start);
 }
 
 // Token Lexer::GenerateNumberToken()
@@ -403,17 +413,17 @@ Token Lexer::GenerateNumberToken()
 //     return Token{_syntaxTree, SyntaxKind::NUMBER, result, pos};
 // }
 
-Token Lexer::GenerateSingleLineComment()
+SyntaxToken Lexer::GenerateSingleLineComment()
 {
     size_t start = pos;
     while (currentChar != '\n' && currentChar != '\0' && currentChar != '\r')
     {
         advance();
     }
-    return Token{_syntaxTree, SyntaxKind::SingleLineComment, input.ToString(start, pos - start), start};
+    return MakeToken(SyntaxKind::SingleLineComment, start, pos - start);
 }
 
-Token Lexer::GenerateMultiLineComment()
+SyntaxToken Lexer::GenerateMultiLineComment()
 {
     size_t start = pos;
     advance();
@@ -426,15 +436,15 @@ Token Lexer::GenerateMultiLineComment()
             TextSpan span(start, pos - start);
             TextLocation location(_syntaxTree->Text, span);
             _diagnostics.ReportUnterminatedComment(location);
-            return Token{_syntaxTree, SyntaxKind::BAD_TOKEN, input.ToString(start, pos - start), start};
+            return MakeToken(SyntaxKind::BAD_TOKEN, start, pos - start);
         }
         advance();
     }
     advance();
     advance();
-    return Token{_syntaxTree, SyntaxKind::MultiLineComment, input.ToString(start, pos - start), start};
+    return MakeToken(SyntaxKind::MultiLineComment, start, pos - start);
 }
-Token Lexer::GenerateIdentifierToken()
+SyntaxToken Lexer::GenerateIdentifierToken()
 {
     size_t start = pos;
     while (isalnum(currentChar))
@@ -442,12 +452,11 @@ Token Lexer::GenerateIdentifierToken()
         advance();
     }
     int length = pos - start;
-    std::string text = input.ToString(start, length);
-    SyntaxKind kind = checkKeyword(text);
-    return Token{_syntaxTree, kind, text, start};
+    SyntaxKind kind = checkKeyword(input.View(start, length));
+    return MakeToken(kind, start, length);
 }
 
-SyntaxKind Lexer::checkKeyword(const std::string &keyword)
+SyntaxKind Lexer::checkKeyword(std::string_view keyword)
 {
     if (keyword == "true")
         return SyntaxKind::TRUE_KEYWORD;
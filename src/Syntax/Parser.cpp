@@ -7,20 +7,21 @@
 Parser::Parser(SyntaxTree *syntaxTree) : _syntaxTree(syntaxTree), _text(syntaxTree->Text), currentTokenIndex(0), currentToken(syntaxTree)
 {
     Lexer lexer(syntaxTree);
-    tokens = lexer.tokenize();
+    syntaxTree->Tokens = lexer.tokenize();
+    tokenCount = syntaxTree->Tokens.size();
 
     DiagnosticBag lexerDiagnostic = lexer.GetDiagnostics();
 
     _diagnostics.AddRange(lexerDiagnostic);
-    currentToken = tokens[0];
+    currentToken = Token(syntaxTree, 0);
 }
 Token Parser::peek(int offset)
 {
-    if (currentTokenIndex + offset >= tokens.size())
+    if (currentTokenIndex + offset >= tokenCount)
     {
-        return tokens[tokens.size() - 1];
+        return Token(_syntaxTree, tokenCount - 1);
     }
-    return tokens[currentTokenIndex + offset];
+    return Token(_syntaxTree, currentTokenIndex + offset);
 }
 
 CompilationUnitNode *Parser::ParseCompilationUnit()
@@ -28,7 +29,7 @@ CompilationUnitNode *Parser::ParseCompilationUnit()
 
     std::vector<MemberSyntax *> members = ParseMembers();
     Token endOfFileToken = Expect(SyntaxKind::END_OF_FILE);
-    return new CompilationUnitNode(_syntaxTree, members, endOfFileToken);
+    return _syntaxTree->Create<CompilationUnitNode>(_syntaxTree, members, endOfFileToken);
 }
 std::vector<MemberSyntax *> Parser::ParseMembers()
 {
@@ -65,7 +66,7 @@ MemberSyntax *Parser::ParseFunctionDeclaration()
     Token closeParenthesis = Expect(SyntaxKind::RPAREN);
     TypeClauseNode *type = ParseOptionalTypeClause();
     BlockStatementSyntax *body = ParseBlockStatement();
-    return new FunctionDeclarationSyntax(_syntaxTree, functionKeyword, identifier, openParenthesis, parameters, closeParenthesis, type, body);
+    return _syntaxTree->Create<FunctionDeclarationSyntax>(_syntaxTree, functionKeyword, identifier, openParenthesis, parameters, closeParenthesis, type, body);
 }
 
 SeparatedSyntaxList<ParameterNode> Parser::ParseParameterList()
@@ -78,7 +79,7 @@ SeparatedSyntaxList<ParameterNode> Parser::ParseParameterList()
 
         if (currentToken.Kind != SyntaxKind::RPAREN)
         {
-            Token *comma = new Token(Expect(SyntaxKind::COMMA));
+            Token *comma = _syntaxTree->Create<Token>(Expect(SyntaxKind::COMMA));
             nodesAndSeparators.push_back(comma);
         }
     }
@@ -89,13 +90,13 @@ ParameterNode *Parser::ParseParameter()
 {
     Token identifier = Expect(SyntaxKind::IDENTIFIER);
     TypeClauseNode *type = ParseTypeClause();
-    return new ParameterNode(_syntaxTree, identifier, type);
+    return _syntaxTree->Create<ParameterNode>(_syntaxTree, identifier, type);
 }
 
 MemberSyntax *Parser::ParseGlobalStatement()
 {
     StatementSyntax *statement = ParseStatement();
-    return new GlobalStatementSyntax(_syntaxTree, statement);
+    return _syntaxTree->Create<GlobalStatementSyntax>(_syntaxTree, statement);
 }
 StatementSyntax *Parser::ParseStatement()
 {
@@ -141,7 +142,7 @@ BlockStatementSyntax *Parser::ParseBlockStatement()
     }
 
     Token closeBraceToken = Expect(SyntaxKind::CLOSE_BRACE);
-    return new BlockStatementSyntax(_syntaxTree, openBraceToken, statements, closeBraceToken);
+    return _syntaxTree->Create<BlockStatementSyntax>(_syntaxTree, openBraceToken, statements, closeBraceToken);
 }
 
 StatementSyntax *Parser::ParseVariableDeclaration()
@@ -161,10 +162,10 @@ StatementSyntax *Parser::ParseVariableDeclaration()
     if (initializer == nullptr && typeClause && typeClause->IsArray && typeClause->Size == nullptr)
     {
 
-        _diagnostics.ReportArraySizeNotSpecified(identifier.Location);
+        _diagnostics.ReportArraySizeNotSpecified(identifier.GetLocation());
     }
 
-    return new VariableDeclarationSyntax(_syntaxTree, keyword, identifier, typeClause, equals, initializer);
+    return _syntaxTree->Create<VariableDeclarationSyntax>(_syntaxTree, keyword, identifier, typeClause, equals, initializer);
 }
 
 TypeClauseNode *Parser::ParseOptionalTypeClause()
@@ -191,10 +192,10 @@ TypeClauseNode *Parser::ParseTypeClause()
             size = ParsePrimaryExpression();
         }
         Expect(SyntaxKind::CLOSE_BRACKET);
-        return new TypeClauseNode(_syntaxTree, colon, identifier, true, size);
+        return _syntaxTree->Create<TypeClauseNode>(_syntaxTree, colon, identifier, true, size);
     }
 
-    return new TypeClauseNode(_syntaxTree, colon, identifier);
+    return _syntaxTree->Create<TypeClauseNode>(_syntaxTree, colon, identifier);
 }
 
 StatementSyntax *Parser::ParseIfStatement()
@@ -203,7 +204,7 @@ StatementSyntax *Parser::ParseIfStatement()
     SyntaxNode *condition = ParseExpression();
     StatementSyntax *thenStatement = ParseStatement();
     ElseClauseSyntax *elseClause = ParseElseClause();
-    return new IfStatementSyntax(_syntaxTree, ifKeyword, condition, thenStatement, elseClause);
+    return _syntaxTree->Create<IfStatementSyntax>(_syntaxTree, ifKeyword, condition, thenStatement, elseClause);
 }
 
 ElseClauseSyntax *Parser::ParseElseClause()
@@ -214,7 +215,7 @@ ElseClauseSyntax *Parser::ParseElseClause()
     }
     Token elseKeyword = Expect(SyntaxKind::ELSE_KEYWORD);
     StatementSyntax *elseStatement = ParseStatement();
-    return new ElseClauseSyntax(_syntaxTree, elseKeyword, elseStatement);
+    return _syntaxTree->Create<ElseClauseSyntax>(_syntaxTree, elseKeyword, elseStatement);
 }
 
 StatementSyntax *Parser::ParseWhileStatement()
@@ -222,7 +223,7 @@ StatementSyntax *Parser::ParseWhileStatement()
     Token whileKeyword = Expect(SyntaxKind::WHILE_KEYWORD);
     SyntaxNode *condition = ParseExpression();
     StatementSyntax *body = ParseStatement();
-    return new WhileStatementSyntax(_syntaxTree, whileKeyword, condition, body);
+    return _syntaxTree->Create<WhileStatementSyntax>(_syntaxTree, whileKeyword, condition, body);
 }
 
 StatementSyntax *Parser::ParseForStatement()
@@ -234,19 +235,19 @@ StatementSyntax *Parser::ParseForStatement()
     Token toKeyword = Expect(SyntaxKind::TO_KEYWORD);
     SyntaxNode *upperBound = ParseExpression();
     StatementSyntax *body = ParseStatement();
-    return new ForStatementSyntax(_syntaxTree, keyword, identifier, equals, lowerBound, toKeyword, upperBound, body);
+    return _syntaxTree->Create<ForStatementSyntax>(_syntaxTree, keyword, identifier, equals, lowerBound, toKeyword, upperBound, body);
 }
 
 StatementSyntax *Parser::ParseBreakStatement()
 {
     Token keyword = Expect(SyntaxKind::BREAK_KEYWORD);
-    return new BreakStatementSyntax(_syntaxTree, keyword);
+    return _syntaxTree->Create<BreakStatementSyntax>(_syntaxTree, keyword);
 }
 
 StatementSyntax *Parser::ParseContinueStatement()
 {
     Token keyword = Expect(SyntaxKind::CONTINUE_KEYWORD);
-    return new ContinueStatementSyntax(_syntaxTree, keyword);
+    return _syntaxTree->Create<ContinueStatementSyntax>(_syntaxTree, keyword);
 }
 
 StatementSyntax *Parser::ParseRetrunStatement()
@@ -257,21 +258,21 @@ StatementSyntax *Parser::ParseRetrunStatement()
     bool isEof = currentToken.Kind == SyntaxKind::END_OF_FILE;
     bool isOnSameLine = !isEof && keywordLine == currentLine;
     SyntaxNode *expression = isOnSameLine ? ParseExpression() : nullptr;
-    return new ReturnStatementSyntax(_syntaxTree, keyword, expression);
+    return _syntaxTree->Create<ReturnStatementSyntax>(_syntaxTree, keyword, expression);
 }
 
 ExpressionStatementSyntax *Parser::ParseExpressionStatement()
 {
     SyntaxNode *expression = ParseExpression();
-    return new ExpressionStatementSyntax(_syntaxTree, expression);
+    return _syntaxTree->Create<ExpressionStatementSyntax>(_syntaxTree, expression);
 }
 
 void Parser::NextToken()
 {
     currentTokenIndex++;
-    if (currentTokenIndex < tokens.size())
+    if (currentTokenIndex < tokenCount)
     {
-        currentToken = tokens[currentTokenIndex];
+        currentToken = Token(_syntaxTree, currentTokenIndex);
     }
 }
 SyntaxNode *Parser::ParseExpression()
@@ -292,7 +293,7 @@ SyntaxNode *Parser::ParseAssignmentExpression()
         Token equals = currentToken;
         NextToken();
         SyntaxNode *right = ParseAssignmentExpression();
-        return new AssignmentExpressionNode(_syntaxTree, identifier, equals, right);
+        return _syntaxTree->Create<AssignmentExpressionNode>(_syntaxTree, identifier, equals, right);
     }
     return ParseBinaryExpression();
 }
@@ -306,7 +307,7 @@ SyntaxNode *Parser::ParseBinaryExpression(int parentPrecedence)
         Token op = currentToken;
         NextToken();
         SyntaxNode *expression = ParseBinaryExpression(unaryPrecedence);
-        left = new UnaryExpressionNode(_syntaxTree, expression, op);
+        left = _syntaxTree->Create<UnaryExpressionNode>(_syntaxTree, expression, op);
     }
     else
     {
@@ -324,7 +325,7 @@ SyntaxNode *Parser::ParseBinaryExpression(int parentPrecedence)
         Token op = currentToken;
         NextToken();
         SyntaxNode *right = ParseBinaryExpression(precedence);
-        left = new BinaryExpressionNode(_syntaxTree, left, right, op);
+        left = _syntaxTree->Create<BinaryExpressionNode>(_syntaxTree, left, right, op);
     }
     return left;
 }
@@ -395,7 +396,7 @@ SyntaxNode *Parser::ParsePrimaryExpression()
         break;
     case SyntaxKind::BAD_TOKEN:
         NextToken();
-        _diagnostics.ReportUnexpectedToken(currentToken.Location, convertSyntaxKindToString(currentToken.Kind), "Primary Expression");
+        _diagnostics.ReportUnexpectedToken(currentToken.GetLocation(), convertSyntaxKindToString(currentToken.Kind), "Primary Expression");
         return nullptr;
         break;
     case SyntaxKind::IDENTIFIER:
@@ -432,12 +433,12 @@ SyntaxNode *Parser::ParseArrayInitializer()
 
         if (currentToken.Kind != SyntaxKind::CLOSE_BRACE)
         {
-            Token *comma = new Token(Expect(SyntaxKind::COMMA));
+            Token *comma = _syntaxTree->Create<Token>(Expect(SyntaxKind::COMMA));
             nodesAndSeparators.push_back(comma);
         }
     }
     Token closeBraceToken = Expect(SyntaxKind::CLOSE_BRACE);
-    return new ArrayInitializerSyntax(_syntaxTree, openBraceToken, nodesAndSeparators, closeBraceToken);
+    return _syntaxTree->Create<ArrayInitializerSyntax>(_syntaxTree, openBraceToken, nodesAndSeparators, closeBraceToken);
 }
 
 SyntaxNode *Parser::ParseArrayAssignmentOrAccessExpression()
@@ -452,9 +453,9 @@ SyntaxNode *Parser::ParseArrayAssignmentOrAccessExpression()
     {
         Token equals = Expect(SyntaxKind::EQUALS);
         SyntaxNode *right = ParseExpression();
-        return new ArrayAssignmentExpressionSyntax(_syntaxTree, identifier, openBracket, index, closeBracket, equals, right);
+        return _syntaxTree->Create<ArrayAssignmentExpressionSyntax>(_syntaxTree, identifier, openBracket, index, closeBracket, equals, right);
     }
-    return new ArrayAccessExpressionSyntax(_syntaxTree, identifier, openBracket, index, closeBracket);
+    return _syntaxTree->Create<ArrayAccessExpressionSyntax>(_syntaxTree, identifier, openBracket, index, closeBracket);
 }
 SyntaxNode *Parser::ParseCallExpression()
 {
@@ -462,7 +463,7 @@ SyntaxNode *Parser::ParseCallExpression()
     Token openParenthesis = Expect(SyntaxKind::LPAREN);
     SeparatedSyntaxList<SyntaxNode> arguments = ParseArguments();
     Token closeParenthesis = Expect(SyntaxKind::RPAREN);
-    return new CallExpressionNode(_syntaxTree, identifier, openParenthesis, arguments, closeParenthesis);
+    return _syntaxTree->Create<CallExpressionNode>(_syntaxTree, identifier, openParenthesis, arguments, closeParenthesis);
 }
 
 SeparatedSyntaxList<SyntaxNode> Parser::ParseArguments()
@@ -475,7 +476,7 @@ SeparatedSyntaxList<SyntaxNode> Parser::ParseArguments()
 
         if (currentToken.Kind != SyntaxKind::RPAREN)
         {
-            Token *comma = new Token(Expect(SyntaxKind::COMMA));
+            Token *comma = _syntaxTree->Create<Token>(Expect(SyntaxKind::COMMA));
             nodesAndSeparators.push_back(comma);
         }
     }
@@ -487,13 +488,13 @@ SyntaxNode *Parser::ParseParenthesizedExpression()
     NextToken();
     SyntaxNode *expression = ParseExpression();
     Expect(SyntaxKind::RPAREN);
-    return new ParenthesizedExpressionNode(_syntaxTree, expression);
+    return _syntaxTree->Create<ParenthesizedExpressionNode>(_syntaxTree, expression);
 }
 
 SyntaxNode *Parser::ParseBooleanLiteral()
 {
     bool isTrue = currentToken.Kind == SyntaxKind::TRUE_KEYWORD;
-    SyntaxNode *node = new LiteralExpressionNode(_syntaxTree, currentToken, isTrue);
+    SyntaxNode *node = _syntaxTree->Create<LiteralExpressionNode>(_syntaxTree, currentToken, isTrue);
     NextToken();
     return node;
 }
@@ -501,18 +502,18 @@ SyntaxNode *Parser::ParseBooleanLiteral()
 SyntaxNode *Parser::ParseStringLiteral()
 {
     Token stringToken = Expect(SyntaxKind::STRING);
-    return new LiteralExpressionNode(_syntaxTree, stringToken);
+    return _syntaxTree->Create<LiteralExpressionNode>(_syntaxTree, stringToken);
 }
 SyntaxNode *Parser::ParseNumberLiteral()
 {
-    SyntaxNode *node = new LiteralExpressionNode(_syntaxTree, currentToken, std::stoll(currentToken.value));
+    SyntaxNode *node = _syntaxTree->Create<LiteralExpressionNode>(_syntaxTree, currentToken, std::stoll(std::string(currentToken.Text())));
     NextToken();
     return node;
 }
 
 SyntaxNode *Parser::ParseDecimalLiteral()
 {
-    SyntaxNode *node = new LiteralExpressionNode(_syntaxTree, currentToken, std::stod(currentToken.value));
+    SyntaxNode *node = _syntaxTree->Create<LiteralExpressionNode>(_syntaxTree, currentToken, std::stod(std::string(currentToken.Text())));
     NextToken();
     return node;
 }
@@ -520,7 +521,7 @@ SyntaxNode *Parser::ParseDecimalLiteral()
 SyntaxNode *Parser::ParseNameExpression()
 {
     Token name = Expect(SyntaxKind::IDENTIFIER);
-    return new NameExpressionNode(_syntaxTree, name);
+    return _syntaxTree->Create<NameExpressionNode>(_syntaxTree, name);
 }
 
 Token Parser::Expect(SyntaxKind kind)
@@ -533,7 +534,16 @@ Token Parser::Expect(SyntaxKind kind)
     }
     else
     {
-        _diagnostics.ReportUnexpectedToken(currentToken.Location, convertSyntaxKindToString(currentToken.Kind), convertSyntaxKindToString(kind));
-        return Token(_syntaxTree, kind, currentToken.value, currentToken.position);
+        _diagnostics.ReportUnexpectedToken(currentToken.GetLocation(), convertSyntaxKindToString(currentToken.Kind), convertSyntaxKindToString(kind));
+        // The missing token takes the place and text of the current one.
+        SyntaxToken token = _syntaxTree->Tokens[currentToken.Index];
+        if (token.Literal < 0 && (token.Kind == SyntaxKind::STRING || kind == SyntaxKind::STRING))
+        {
+            token.Literal = _syntaxTree->Literals.size();
+            _syntaxTree->Literals.emplace_back(currentToken.Text());
+        }
+        token.Kind = kind;
+        _syntaxTree->Tokens.push_back(token);
+        return Token(_syntaxTree, _syntaxTree->Tokens.size() - 1);
     }
 }
\ No newline at end of file
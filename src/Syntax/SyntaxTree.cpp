@@ -2,16 +2,16 @@
 #include "CodeAnalysis/Parser.h"
 #include "CodeAnalysis/SyntaxTree.h"
 #include <fstream>
-SyntaxTree SyntaxTree::Parse(std::string text)
+SyntaxTree *SyntaxTree::Parse(std::string text)
 {
     SourceText sourceText = SourceText::From(text);
     return Parse(sourceText);
 }
 
-SyntaxTree SyntaxTree::Parse(SourceText text)
+SyntaxTree *SyntaxTree::Parse(SourceText text)
 {
 
-    return SyntaxTree(text, Parse);
+    return new SyntaxTree(text, Parse);
 }
 
 void SyntaxTree::Parse(SyntaxTree *syntaxTree, CompilationUnitNode *&root, std::vector<Diagnostic> &diagnostics)
@@ -42,7 +42,7 @@ std::vector<Token> SyntaxTree::ParseTokens(std::string text, std::vector<Diagnos
     return ParseTokens(sourceText, diagnostics);
 }
 
-SyntaxTree SyntaxTree::Load(std::string filename)
+SyntaxTree *SyntaxTree::Load(std::string filename)
 {
     std::ifstream file(filename);
     if (!file.is_open())
@@ -62,10 +62,10 @@ std::vector<Token> SyntaxTree::ParseTokens(SourceText text)
 void ParseTokensHn(SyntaxTree *st, CompilationUnitNode *&root, std::vector<Diagnostic> &d)
 {
     Lexer lexer(st);
-    std::vector<Token> tokens = lexer.tokenize();
-    if (tokens[tokens.size() - 1].Kind == SyntaxKind::END_OF_FILE)
+    st->Tokens = lexer.tokenize();
+    if (st->Tokens.back().Kind == SyntaxKind::END_OF_FILE)
     {
-        root = new CompilationUnitNode(st, {}, tokens[tokens.size() - 1]);
+        root = st->Create<CompilationUnitNode>(st, std::vector<MemberSyntax *>(), Token(st, st->Tokens.size() - 1));
     }
 
     d = lexer.GetDiagnostics().GetDiagnostics();
@@ -77,9 +77,19 @@ std::vector<Token> SyntaxTree::ParseTokens(SourceText text, std::vector<Diagnost
 
     SyntaxTree *syntaxTree = new SyntaxTree(text, ParseTokensHn);
     diagnostics = syntaxTree->Diagnostics;
+    delete syntaxTree;
     return tokens;
 }
 
+std::string_view SyntaxTree::GetText(const SyntaxToken &token) const
+{
+    if (token.Literal >= 0)
+        return Literals[token.Literal];
+    if (token.Kind == SyntaxKind::STRING)
+        return Text.View(token.Start + 1, token.Length - 2);
+    return Text.View(token.Start, token.Length);
+}
+
 void SyntaxNode::PrettyPrint(std::ostream &os, SyntaxNode *node, std::string indent, bool isLast)
 {
     const std::string RESET_COLOR = "\033[0m";
@@ -95,7 +105,7 @@ void SyntaxNode::PrettyPrint(std::ostream &os, SyntaxNode *node, std::string ind
 
     if (Token *token = dynamic_cast<Token *>(node))
     {
-        os << GREEN << convertSyntaxKindToString(node->Kind) << " " << token->value;
+        os << GREEN << convertSyntaxKindToString(node->Kind) << " " << token->Text();
     }
 
     else if (StatementSyntax *stmt = dynamic_cast<StatementSyntax *>(node))
@@ -1,12 +1,16 @@
 #include "CodeAnalysis/SourceText.h"
 #include <vector>
-std::vector<TextLine> SourceText::ParseLines(const std::string &text)
+SourceText::SourceText(const std::string &text, std::string filename)
+    : _buffer(std::make_shared<const Buffer>(Buffer{text, filename, ParseLines(text)}))
 {
-    std::vector<TextLine> result;
+}
+
+std::vector<uint32_t> SourceText::ParseLines(const std::string &text)
+{
+    std::vector<uint32_t> result = {0};
     int position = 0;
-    int lineStart = 0;
 
-    while (position < text.length())
+    while (position < static_cast<int>(text.length()))
     {
         int lineBreakWidth = GetLineBreakWidth(text, position);
 
@@ -16,32 +20,18 @@ std::vector<TextLine> SourceText::ParseLines(const std::string &text)
         }
         else
         {
-            AddLine(result, *this, position, lineStart, lineBreakWidth);
             position += lineBreakWidth;
-            lineStart = position;
+            result.push_back(position);
         }
     }
 
-    if (position >= lineStart)
-    {
-        AddLine(result, *this, position, lineStart, 0);
-    }
-
     return result;
 }
 
-void SourceText::AddLine(std::vector<TextLine> &result, const SourceText &sourceText, int position, int lineStart, int lineBreakWidth)
-{
-    int lineLength = position - lineStart;
-    int lineLengthIncludingLineBreak = lineLength + lineBreakWidth;
-
-    result.emplace_back(sourceText, lineStart, lineLength, lineLengthIncludingLineBreak);
-}
-
 int SourceText::GetLineBreakWidth(const std::string &text, int position)
 {
     char c = text[position];
-    char l = (position + 1 >= text.length()) ? '\0' : text[position + 1];
+    char l = (position + 1 >= static_cast<int>(text.length())) ? '\0' : text[position + 1];
 
     if (c == '\r' && l == '\n')
     {
@@ -56,15 +46,31 @@ int SourceText::GetLineBreakWidth(const std::string &text, int position)
     return 0;
 }
 
+TextLine SourceText::GetLine(int index) const
+{
+    const Buffer &data = Data();
+    int start = data.LineStarts[index];
+    if (index + 1 == static_cast<int>(data.LineStarts.size()))
+    {
+        int length = static_cast<int>(data.Text.length()) - start;
+        return TextLine(*this, start, length, length);
+    }
+
+    int next = data.LineStarts[index + 1];
+    int lineBreakWidth = next - start >= 2 && data.Text[next - 2] == '\r' && data.Text[next - 1] == '\n' ? 2 : 1;
+    return TextLine(*this, start, next - start - lineBreakWidth, next - start);
+}
+
 int SourceText::GetLineIndex(int position) const
 {
+    const std::vector<uint32_t> &lines = Data().LineStarts;
     int lower = 0;
-    int upper = static_cast<int>(_lines.size()) - 1;
+    int upper = static_cast<int>(lines.size()) - 1;
 
     while (lower <= upper)
     {
         int index = lower + (upper - lower) / 2;
-        int start = _lines[index].Start;
+        int start = lines[index];
 
         if (position == start)
         {
@@ -0,0 +1,91 @@
+#include "CodeAnalysis/Value.h"
+
+ArrayObject::ArrayObject(ValueKind elementKind, const Value *elements, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (elements[i].GetKind() != elementKind)
+            elementKind = ValueKind::None;
+    }
+
+    ElementKind = elementKind;
+    switch (ElementKind)
+    {
+    case ValueKind::Integer:
+        Integers.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            Integers.push_back(elements[i].AsInteger());
+        break;
+    case ValueKind::Float:
+        Floats.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            Floats.push_back(elements[i].AsFloat());
+        break;
+    case ValueKind::Boolean:
+        Booleans.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            Booleans.push_back(elements[i].AsBoolean());
+        break;
+    default:
+        Elements.assign(elements, elements + count);
+        break;
+    }
+}
+
+void ArrayObject::Box()
+{
+    size_t size = Size();
+    Elements.reserve(size);
+    for (size_t i = 0; i < size; i++)
+        Elements.push_back(Get(i));
+
+    ElementKind = ValueKind::None;
+    Integers = {};
+    Floats = {};
+    Booleans = {};
+}
+
+std::string Value::ToString() const
+{
+    switch (_kind)
+    {
+    case ValueKind::Integer:
+        return std::to_string(_integer);
+    case ValueKind::Float:
+        return std::to_string(_float);
+    case ValueKind::Boolean:
+        return std::to_string(_boolean);
+    case ValueKind::String:
+        return _string->Text;
+    case ValueKind::Array:
+    {
+        std::string result;
+        for (size_t i = 0; i < _array->Size(); i++)
+            result += _array->Get(i).ToString() + " ";
+        return result;
+    }
+    default:
+        return "";
+    }
+}
+
+std::ostream &operator<<(std::ostream &os, const Value &value)
+{
+    switch (value._kind)
+    {
+    case ValueKind::Integer:
+        return os << value._integer;
+    case ValueKind::Float:
+        return os << value._float;
+    case ValueKind::Boolean:
+        return os << value._boolean;
+    case ValueKind::String:
+        return os << value._string->Text;
+    case ValueKind::Array:
+        for (size_t i = 0; i < value._array->Size(); i++)
+            os << value._array->Get(i) << " ";
+        return os;
+    default:
+        return os;
+    }
+}
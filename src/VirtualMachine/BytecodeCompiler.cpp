@@ -0,0 +1,517 @@
+#include "CodeAnalysis/VirtualMachine.h"
+#include "CodeAnalysis/Evaluator.h"
+#include "CodeAnalysis/Lowerer.h"
+#include <stdexcept>
+
+// The entry point returns the value of the last statement it ran, so a
+// statement only has to keep its value when the next one may not replace it.
+static bool IsResultOverwritten(const std::vector<BoundStatement *> &statements, size_t index)
+{
+    for (size_t i = index + 1; i < statements.size(); i++)
+    {
+        BoundNodeKind kind = statements[i]->GetKind();
+        if (kind != BoundNodeKind::LabelStatement)
+            return kind == BoundNodeKind::ExpressionStatement || kind == BoundNodeKind::VariableDeclaration;
+    }
+    return false;
+}
+
+static bool ContainsAssignment(BoundExpression *node)
+{
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::AssignmentExpression:
+    case BoundNodeKind::ArrayAssignmentExpression:
+        return true;
+    case BoundNodeKind::UnaryExpression:
+        return ContainsAssignment(((BoundUnaryExpression *)node)->Operand);
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        return ContainsAssignment(binary->Left) || ContainsAssignment(binary->Right);
+    }
+    case BoundNodeKind::ConversionExpression:
+        return ContainsAssignment(((BoundConversionExpression *)node)->Expression);
+    case BoundNodeKind::ArrayAccessExpression:
+    {
+        BoundArrayAccessExpression *access = (BoundArrayAccessExpression *)node;
+        return ContainsAssignment(access->Variable) || ContainsAssignment(access->Index);
+    }
+    case BoundNodeKind::CallExpression:
+        for (auto &argument : ((BoundCallExpression *)node)->Arguments)
+        {
+            if (ContainsAssignment(argument))
+                return true;
+        }
+        return false;
+    case BoundNodeKind::ArrayInitializerExpression:
+        for (auto &element : ((BoundArrayInitializerExpression *)node)->Elements)
+        {
+            if (ContainsAssignment(element))
+                return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+static bool TryGetIntegerOpCode(const BoundBinaryOperator *op, OpCode &result)
+{
+    if (op->LeftType != TypeSymbol::Integer || op->RightType != TypeSymbol::Integer)
+        return false;
+
+    switch (op->Kind)
+    {
+    case BoundBinaryOperatorKind::Addition:
+        result = OpCode::AddInt;
+        return true;
+    case BoundBinaryOperatorKind::Subtraction:
+        result = OpCode::SubtractInt;
+        return true;
+    case BoundBinaryOperatorKind::Multiplication:
+        result = OpCode::MultiplyInt;
+        return true;
+    case BoundBinaryOperatorKind::Division:
+        result = OpCode::DivideInt;
+        return true;
+    case BoundBinaryOperatorKind::Equals:
+        result = OpCode::EqualsInt;
+        return true;
+    case BoundBinaryOperatorKind::NotEquals:
+        result = OpCode::NotEqualsInt;
+        return true;
+    case BoundBinaryOperatorKind::Less:
+        result = OpCode::LessInt;
+        return true;
+    case BoundBinaryOperatorKind::LessOrEquals:
+        result = OpCode::LessOrEqualsInt;
+        return true;
+    case BoundBinaryOperatorKind::Greater:
+        result = OpCode::GreaterInt;
+        return true;
+    case BoundBinaryOperatorKind::GreaterOrEquals:
+        result = OpCode::GreaterOrEqualsInt;
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::unique_ptr<BytecodeProgram> BytecodeCompiler::Compile(BoundProgram *program)
+{
+    std::unique_ptr<BytecodeProgram> output = std::make_unique<BytecodeProgram>();
+    BytecodeCompiler compiler(output.get());
+    output->Globals = program->Globals;
+    output->GlobalCount = program->GlobalCount;
+    output->Constants = program->Constants;
+
+    for (auto &[function, body] : program->Functions)
+    {
+        compiler._functionIndices[function] = output->Functions.size();
+        output->Functions.push_back(BytecodeFunction());
+        output->Functions.back().Name = function.Name;
+    }
+
+    for (auto &[function, body] : program->Functions)
+    {
+        BytecodeFunction &bytecode = output->Functions[compiler._functionIndices[function]];
+        compiler.CompileFunction(bytecode, function.Parameters.size(), body, false);
+    }
+
+    output->EntryPoint = output->Functions.size();
+    output->Functions.push_back(BytecodeFunction());
+    output->Functions.back().Name = "<main>";
+    compiler.CompileFunction(output->Functions.back(), 0, program->statement, true);
+
+    return output;
+}
+
+void BytecodeCompiler::CompileFunction(BytecodeFunction &function, int parameterCount, BoundBlockStatement *body, bool isEntryPoint)
+{
+    _function = &function;
+    _statementOffsets.clear();
+    _fixups.clear();
+    if (!body->LabelsResolved)
+        Lowerer::ResolveLabels(body);
+    _nextRegister = body->LocalCount;
+
+    function.ParameterCount = parameterCount;
+    _resultRegister = isEntryPoint ? _nextRegister++ : -1;
+    _localCount = _nextRegister;
+    function.RegisterCount = _nextRegister;
+
+    for (size_t i = 0; i < body->Statements.size(); i++)
+    {
+        _statementOffsets.push_back(function.Code.size());
+        _statementResult = IsResultOverwritten(body->Statements, i) ? -1 : _resultRegister;
+        CompileStatement(body->Statements[i]);
+        _nextRegister = _localCount;
+    }
+    _statementOffsets.push_back(function.Code.size());
+    Emit(OpCode::Return, _resultRegister);
+
+    for (auto &[index, target] : _fixups)
+        function.Code[index].A = _statementOffsets[target];
+}
+
+void BytecodeCompiler::CompileStatement(BoundStatement *node)
+{
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::VariableDeclaration:
+    {
+        BoundVariableDeclaration *declaration = (BoundVariableDeclaration *)node;
+        CompileAssignment(declaration->Variable, declaration->Initializer, _statementResult);
+        break;
+    }
+    case BoundNodeKind::ExpressionStatement:
+        CompileExpression(((BoundExpressionStatement *)node)->Expression, _statementResult);
+        break;
+    case BoundNodeKind::LabelStatement:
+        break;
+    case BoundNodeKind::GotoStatement:
+        _fixups.push_back({Emit(OpCode::Jump), ((BoundGotoStatement *)node)->Target});
+        break;
+    case BoundNodeKind::ConditionalGotoStatement:
+    {
+        BoundConditionalGotoStatement *conditionalGoto = (BoundConditionalGotoStatement *)node;
+        int condition = CompileExpression(conditionalGoto->Condition);
+        OpCode op = conditionalGoto->JumpIfTrue ? OpCode::JumpIfTrue : OpCode::JumpIfFalse;
+        _fixups.push_back({Emit(op, 0, condition), conditionalGoto->Target});
+        break;
+    }
+    case BoundNodeKind::CountedGotoStatement:
+    {
+        BoundCountedGotoStatement *countedGoto = (BoundCountedGotoStatement *)node;
+        const VariableSymbol &variable = ((BoundVariableExpression *)countedGoto->Variable)->Variable;
+        int upperBound = CompileExpression(countedGoto->UpperBound);
+        if (variable.GetKind() == SymbolKind::GlobalVariable)
+            _fixups.push_back({Emit(OpCode::ForLoopGlobal, 0, GlobalIndex(variable), upperBound), countedGoto->Target});
+        else
+            _fixups.push_back({Emit(OpCode::ForLoop, 0, LocalRegister(variable), upperBound), countedGoto->Target});
+        break;
+    }
+    case BoundNodeKind::ReturnStatement:
+    {
+        BoundReturnStatement *returnStatement = (BoundReturnStatement *)node;
+        if (returnStatement->Expression == nullptr)
+            Emit(OpCode::Return, -1);
+        else
+            Emit(OpCode::Return, CompileExpression(returnStatement->Expression));
+        break;
+    }
+    default:
+        throw std::runtime_error("Unexpected node kind: " + convertBoundNodeKindToString(node->GetKind()));
+    }
+}
+
+int BytecodeCompiler::CompileExpression(BoundExpression *node, int target)
+{
+    switch (node->GetKind())
+    {
+    case BoundNodeKind::LiteralExpression:
+    {
+        int destination = Destination(target);
+        Emit(OpCode::LoadConstant, destination, ConstantIndex((BoundLiteralExpression *)node));
+        return destination;
+    }
+    case BoundNodeKind::VariableExpression:
+    {
+        VariableSymbol &variable = ((BoundVariableExpression *)node)->Variable;
+        if (variable.GetKind() == SymbolKind::GlobalVariable)
+        {
+            int destination = Destination(target);
+            Emit(OpCode::LoadGlobal, destination, GlobalIndex(variable));
+            return destination;
+        }
+
+        int local = LocalRegister(variable);
+        if (target < 0 || target == local)
+            return local;
+        Emit(OpCode::Move, target, local);
+        return target;
+    }
+    case BoundNodeKind::AssignmentExpression:
+    {
+        BoundAssignmentExpression *assignment = (BoundAssignmentExpression *)node;
+        return CompileAssignment(assignment->Variable, assignment->Expression, target);
+    }
+    case BoundNodeKind::UnaryExpression:
+    {
+        BoundUnaryExpression *unary = (BoundUnaryExpression *)node;
+        if (unary->Op->Kind == BoundUnaryOperatorKind::Identity)
+            return CompileExpression(unary->Operand, target);
+
+        int operand = CompileExpression(unary->Operand);
+        int destination = Destination(target);
+        Emit(OpCode::Unary, destination, operand, 0, HandlerIndex(unary->Op->Handler));
+        return destination;
+    }
+    case BoundNodeKind::BinaryExpression:
+    {
+        BoundBinaryExpression *binary = (BoundBinaryExpression *)node;
+        if (binary->Op->Kind == BoundBinaryOperatorKind::LogicalAnd || binary->Op->Kind == BoundBinaryOperatorKind::LogicalOr)
+            return CompileLogicalExpression(binary, target);
+
+        int left = CompileExpression(binary->Left);
+        if (left < _localCount && ContainsAssignment(binary->Right))
+        {
+            int copy = AllocateRegister();
+            Emit(OpCode::Move, copy, left);
+            left = copy;
+        }
+        int right = CompileExpression(binary->Right);
+        int destination = Destination(target);
+
+        OpCode op;
+        if (TryGetIntegerOpCode(binary->Op, op))
+            Emit(op, destination, left, right);
+        else
+            Emit(OpCode::Binary, destination, left, right, HandlerIndex(binary->Op->Handler));
+        return destination;
+    }
+    case BoundNodeKind::CallExpression:
+        return CompileCallExpression((BoundCallExpression *)node, target);
+    case BoundNodeKind::ConversionExpression:
+    {
+        BoundConversionExpression *conversion = (BoundConversionExpression *)node;
+        int value = CompileExpression(conversion->Expression);
+        int destination = Destination(target);
+        Emit(OpCode::Convert, destination, value, TypeIndex(conversion->type));
+        return destination;
+    }
+    case BoundNodeKind::ArrayInitializerExpression:
+    {
+        BoundArrayInitializerExpression *initializer = (BoundArrayInitializerExpression *)node;
+        bool isConstant = true;
+        for (auto &element : initializer->Elements)
+        {
+            if (element->GetKind() != BoundNodeKind::LiteralExpression)
+            {
+                isConstant = false;
+                break;
+            }
+        }
+
+        ValueKind elementKind = Evaluator::GetElementKind(initializer->type);
+        if (isConstant)
+        {
+            std::vector<Value> elements;
+            elements.reserve(initializer->Elements.size());
+            for (auto &element : initializer->Elements)
+                elements.push_back(ConstantPool::Decode((BoundLiteralExpression *)element));
+
+            int destination = Destination(target);
+            Emit(OpCode::LoadConstant, destination, AddConstant(Value(elementKind, elements.data(), elements.size())));
+            return destination;
+        }
+
+        int count = initializer->Elements.size();
+        int first = AllocateRegisters(count);
+        for (int i = 0; i < count; i++)
+        {
+            CompileExpression(initializer->Elements[i], first + i);
+            _nextRegister = first + count;
+        }
+        int destination = Destination(target);
+        Emit(OpCode::NewArray, destination, first, count, (uint8_t)elementKind);
+        return destination;
+    }
+    case BoundNodeKind::ArrayAccessExpression:
+    {
+        BoundArrayAccessExpression *access = (BoundArrayAccessExpression *)node;
+        int index = CompileExpression(access->Index);
+        if (access->Variable->GetKind() == BoundNodeKind::VariableExpression)
+        {
+            VariableSymbol &variable = ((BoundVariableExpression *)access->Variable)->Variable;
+            if (variable.GetKind() == SymbolKind::GlobalVariable)
+            {
+                int destination = Destination(target);
+                Emit(OpCode::IndexGlobal, destination, GlobalIndex(variable), index);
+                return destination;
+            }
+        }
+        int array = CompileExpression(access->Variable);
+        int destination = Destination(target);
+        Emit(OpCode::Index, destination, array, index);
+        return destination;
+    }
+    case BoundNodeKind::ArrayAssignmentExpression:
+        return CompileArrayAssignmentExpression((BoundArrayAssignmentExpression *)node, target);
+    default:
+        throw std::runtime_error("Unexpected node kind: " + convertBoundNodeKindToString(node->GetKind()));
+    }
+}
+
+int BytecodeCompiler::CompileLogicalExpression(BoundBinaryExpression *node, int target)
+{
+    // The result gets its own register so that the right operand never sees
+    // a target that the left operand has already overwritten.
+    int result = AllocateRegister();
+    CompileExpression(node->Left, result);
+    OpCode op = node->Op->Kind == BoundBinaryOperatorKind::LogicalAnd ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+    int jump = Emit(op, 0, result);
+    CompileExpression(node->Right, result);
+    _function->Code[jump].A = _function->Code.size();
+
+    if (target < 0)
+        return result;
+    Emit(OpCode::Move, target, result);
+    return target;
+}
+
+int BytecodeCompiler::CompileCallExpression(BoundCallExpression *node, int target)
+{
+    int count = node->Arguments.size();
+    int first = AllocateRegisters(count);
+    for (int i = 0; i < count; i++)
+    {
+        CompileExpression(node->Arguments[i], first + i);
+        _nextRegister = first + count;
+    }
+
+    int destination = target;
+    if (destination < 0)
+    {
+        _nextRegister = first;
+        destination = AllocateRegister();
+    }
+
+    if (Evaluator::IsBuiltInFunction(node->Function))
+    {
+        Emit(OpCode::CallBuiltIn, destination, node->Function.BuiltIn, first);
+    }
+    else
+    {
+        auto it = _functionIndices.find(node->Function);
+        if (it == _functionIndices.end())
+            throw std::runtime_error("Undefined function: " + node->Function.Name);
+        Emit(OpCode::Call, destination, it->second, first);
+    }
+    return destination;
+}
+
+int BytecodeCompiler::CompileArrayAssignmentExpression(BoundArrayAssignmentExpression *node, int target)
+{
+    int index = CompileExpression(node->Index);
+    int value = CompileExpression(node->Expression, target);
+
+    if (node->Variable.GetKind() == SymbolKind::GlobalVariable)
+    {
+        Emit(OpCode::SetGlobalIndex, GlobalIndex(node->Variable), index, value);
+    }
+    else
+    {
+        Emit(OpCode::SetIndex, LocalRegister(node->Variable), index, value);
+    }
+    return value;
+}
+
+int BytecodeCompiler::CompileAssignment(const VariableSymbol &variable, BoundExpression *expression, int target)
+{
+    if (variable.GetKind() == SymbolKind::GlobalVariable)
+    {
+        int value = CompileExpression(expression, target);
+        Emit(OpCode::StoreGlobal, value, GlobalIndex(variable));
+        return value;
+    }
+
+    int local = LocalRegister(variable);
+    CompileExpression(expression, local);
+    if (target < 0 || target == local)
+        return local;
+    Emit(OpCode::Move, target, local);
+    return target;
+}
+
+int BytecodeCompiler::Emit(OpCode op, int a, int b, int c, uint8_t kind)
+{
+    Instruction instruction;
+    instruction.Op = op;
+    instruction.Kind = kind;
+    instruction.A = a;
+    instruction.B = b;
+    instruction.C = c;
+    _function->Code.push_back(instruction);
+    return _function->Code.size() - 1;
+}
+
+int BytecodeCompiler::AllocateRegister()
+{
+    return AllocateRegisters(1);
+}
+
+int BytecodeCompiler::AllocateRegisters(int count)
+{
+    int first = _nextRegister;
+    _nextRegister += count;
+    if (_nextRegister > _function->RegisterCount)
+        _function->RegisterCount = _nextRegister;
+    return first;
+}
+
+int BytecodeCompiler::Destination(int target)
+{
+    return target >= 0 ? target : AllocateRegister();
+}
+
+int BytecodeCompiler::LocalRegister(const VariableSymbol &variable)
+{
+    if (variable.Slot < 0 || variable.Slot >= _localCount)
+        throw std::runtime_error("Unresolved local variable: " + variable.Name);
+    return variable.Slot;
+}
+
+int BytecodeCompiler::GlobalIndex(const VariableSymbol &variable)
+{
+    if (variable.Slot < 0 || variable.Slot >= _output->GlobalCount)
+        throw std::runtime_error("Unresolved global variable: " + variable.Name);
+    return variable.Slot;
+}
+
+int BytecodeCompiler::ConstantIndex(BoundLiteralExpression *node)
+{
+    if (node->ConstantIndex < 0)
+        return AddConstant(ConstantPool::Decode(node));
+    return node->ConstantIndex;
+}
+
+int BytecodeCompiler::AddConstant(Value value)
+{
+    _output->Constants.push_back(std::move(value));
+    return _output->Constants.size() - 1;
+}
+
+int BytecodeCompiler::TypeIndex(const TypeSymbol &type)
+{
+    for (size_t i = 0; i < _output->Types.size(); i++)
+    {
+        if (_output->Types[i] == type)
+            return i;
+    }
+    _output->Types.push_back(type);
+    return _output->Types.size() - 1;
+}
+
+int BytecodeCompiler::HandlerIndex(BinaryOperatorHandler handler)
+{
+    for (size_t i = 0; i < _output->BinaryHandlers.size(); i++)
+    {
+        if (_output->BinaryHandlers[i] == handler)
+            return i;
+    }
+    _output->BinaryHandlers.push_back(handler);
+    return _output->BinaryHandlers.size() - 1;
+}
+
+int BytecodeCompiler::HandlerIndex(UnaryOperatorHandler handler)
+{
+    for (size_t i = 0; i < _output->UnaryHandlers.size(); i++)
+    {
+        if (_output->UnaryHandlers[i] == handler)
+            return i;
+    }
+    _output->UnaryHandlers.push_back(handler);
+    return _output->UnaryHandlers.size() - 1;
+}
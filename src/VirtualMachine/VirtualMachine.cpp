@@ -0,0 +1,195 @@
+#include "CodeAnalysis/VirtualMachine.h"
+#include "CodeAnalysis/Evaluator.h"
+#include <stdexcept>
+
+Value VirtualMachine::Run()
+{
+    _globals.resize(_program->GlobalCount);
+    for (const auto &[variable, value] : _variables)
+    {
+        if (variable.Slot >= 0 && static_cast<size_t>(variable.Slot) < _globals.size())
+            _globals[variable.Slot] = value;
+    }
+
+    Value result = Execute();
+
+    for (const auto &variable : _program->Globals)
+    {
+        _variables.erase(variable);
+        _variables.emplace(variable, _globals[variable.Slot]);
+    }
+    return result;
+}
+
+void VirtualMachine::EnsureRegisters(size_t count)
+{
+    if (_registers.size() < count)
+        _registers.resize(std::max(count, _registers.size() * 2));
+}
+
+Value VirtualMachine::Execute()
+{
+    const BytecodeFunction *function = &_program->Functions[_program->EntryPoint];
+    EnsureRegisters(function->RegisterCount);
+    _frames.push_back({function, 0, 0, nullptr});
+
+    const Value *constants = _program->Constants.data();
+    const BinaryOperatorHandler *binaryHandlers = _program->BinaryHandlers.data();
+    const UnaryOperatorHandler *unaryHandlers = _program->UnaryHandlers.data();
+    const BuiltInFunction *builtIns = BuiltInFunctions::GetAll().data();
+    const Instruction *code = function->Code.data();
+    const Instruction *pc = code;
+    size_t base = 0;
+    Value *r = _registers.data();
+
+    while (true)
+    {
+        const Instruction &instruction = *pc++;
+        switch (instruction.Op)
+        {
+        case OpCode::Move:
+            r[instruction.A] = r[instruction.B];
+            break;
+        case OpCode::LoadConstant:
+            r[instruction.A] = constants[instruction.B];
+            break;
+        case OpCode::LoadGlobal:
+            r[instruction.A] = _globals[instruction.B];
+            break;
+        case OpCode::StoreGlobal:
+            _globals[instruction.B] = r[instruction.A];
+            break;
+
+        case OpCode::AddInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() + r[instruction.C].AsInteger());
+            break;
+        case OpCode::SubtractInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() - r[instruction.C].AsInteger());
+            break;
+        case OpCode::MultiplyInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() * r[instruction.C].AsInteger());
+            break;
+        case OpCode::DivideInt:
+            if (r[instruction.C].AsInteger() == 0)
+                throw std::runtime_error("Division by zero");
+            r[instruction.A] = Value(r[instruction.B].AsInteger() / r[instruction.C].AsInteger());
+            break;
+        case OpCode::EqualsInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() == r[instruction.C].AsInteger());
+            break;
+        case OpCode::NotEqualsInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() != r[instruction.C].AsInteger());
+            break;
+        case OpCode::LessInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() < r[instruction.C].AsInteger());
+            break;
+        case OpCode::LessOrEqualsInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() <= r[instruction.C].AsInteger());
+            break;
+        case OpCode::GreaterInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() > r[instruction.C].AsInteger());
+            break;
+        case OpCode::GreaterOrEqualsInt:
+            r[instruction.A] = Value(r[instruction.B].AsInteger() >= r[instruction.C].AsInteger());
+            break;
+        case OpCode::Binary:
+            r[instruction.A] = binaryHandlers[instruction.Kind](r[instruction.B], r[instruction.C]);
+            break;
+        case OpCode::Unary:
+            r[instruction.A] = unaryHandlers[instruction.Kind](r[instruction.B]);
+            break;
+        case OpCode::Convert:
+            r[instruction.A] = Evaluator::ApplyConversion(_program->Types[instruction.C], r[instruction.B]);
+            break;
+
+        case OpCode::Jump:
+            pc = code + instruction.A;
+            break;
+        case OpCode::JumpIfTrue:
+            if (r[instruction.B].AsBoolean())
+                pc = code + instruction.A;
+            break;
+        case OpCode::JumpIfFalse:
+            if (!r[instruction.B].AsBoolean())
+                pc = code + instruction.A;
+            break;
+        case OpCode::ForLoop:
+        {
+            long long next = r[instruction.B].AsInteger() + 1;
+            r[instruction.B] = Value(next);
+            if (next <= r[instruction.C].AsInteger())
+                pc = code + instruction.A;
+            break;
+        }
+        case OpCode::ForLoopGlobal:
+        {
+            long long next = _globals[instruction.B].AsInteger() + 1;
+            _globals[instruction.B] = Value(next);
+            if (next <= r[instruction.C].AsInteger())
+                pc = code + instruction.A;
+            break;
+        }
+
+        case OpCode::Call:
+        {
+            const BytecodeFunction *callee = &_program->Functions[instruction.B];
+            size_t calleeBase = base + instruction.C;
+            _frames.back().Pc = pc;
+            _frames.push_back({callee, calleeBase, base + instruction.A, nullptr});
+            if ((calleeBase + callee->RegisterCount) * sizeof(Value) + _frames.size() * sizeof(Frame) > _stackLimit)
+                throw std::runtime_error("Stack overflow");
+            EnsureRegisters(calleeBase + callee->RegisterCount);
+
+            function = callee;
+            code = function->Code.data();
+            pc = code;
+            base = calleeBase;
+            r = _registers.data() + base;
+            break;
+        }
+        case OpCode::CallBuiltIn:
+            r[instruction.A] = builtIns[instruction.B].Handler(r + instruction.C);
+            break;
+        case OpCode::Return:
+        {
+            Value result = instruction.A >= 0 ? std::move(r[instruction.A]) : Value();
+            Frame frame = _frames.back();
+            _frames.pop_back();
+
+            for (int i = 0; i < frame.Function->RegisterCount; i++)
+                r[i] = Value();
+
+            if (_frames.empty())
+                return result;
+
+            _registers[frame.ReturnRegister] = std::move(result);
+
+            const Frame &caller = _frames.back();
+            function = caller.Function;
+            code = function->Code.data();
+            pc = caller.Pc;
+            base = caller.Base;
+            r = _registers.data() + base;
+            break;
+        }
+
+        case OpCode::NewArray:
+            r[instruction.A] = Value((ValueKind)instruction.Kind, r + instruction.B, instruction.C);
+            break;
+        case OpCode::Index:
+            r[instruction.A] = Evaluator::LoadElement(r[instruction.B], r[instruction.C].AsInteger());
+            break;
+        case OpCode::SetIndex:
+            Evaluator::StoreElement(r[instruction.A], r[instruction.B].AsInteger(), r[instruction.C]);
+            break;
+        case OpCode::IndexGlobal:
+            r[instruction.A] = Evaluator::LoadElement(_globals[instruction.B], r[instruction.C].AsInteger());
+            break;
+        case OpCode::SetGlobalIndex:
+            Evaluator::StoreElement(_globals[instruction.A], r[instruction.B].AsInteger(), r[instruction.C]);
+            break;
+        default:
+            throw std::runtime_error("Unexpected opcode");
+        }
+    }
+}